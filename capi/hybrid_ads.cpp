@@ -0,0 +1,199 @@
+#include "hybrid_ads.h"
+
+#include <mealy.hpp>
+#include <reachability.hpp>
+#include <server.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// A session of the server, and the tests which are generated but not yet pulled
+struct hads_session {
+	explicit hads_session(session_options const & opts) : generator(opts) {}
+
+	session generator;
+	deque<word> pending;
+	bool finished = false;
+};
+
+namespace {
+thread_local string last_error;
+
+// Tests are generated in chunks, as resuming the generation has some overhead
+const size_t chunk_size = 256;
+
+session_options to_session_options(hads_options const & o) {
+	if (o.mode < HADS_ALL || o.mode > HADS_RANDOM) throw runtime_error("Invalid mode");
+	if (o.suffixes < HADS_HADS || o.suffixes > HADS_NONE) throw runtime_error("Invalid suffixes");
+
+	session_options ret;
+	ret.fixed_part = o.mode != HADS_RANDOM;
+	ret.random_part = o.mode != HADS_FIXED;
+	ret.no_suffix = o.suffixes == HADS_NONE;
+	ret.use_distinguishing_sequence = o.suffixes == HADS_HADS;
+	switch (o.prefixes) {
+	case HADS_MINIMAL:
+		ret.prefixes = minimal_transfer_sequences;
+		break;
+	case HADS_LEXMIN:
+		ret.prefixes = canonical_transfer_sequences;
+		break;
+	case HADS_BUGGY:
+		ret.prefixes = buggy_transfer_sequences;
+		break;
+	case HADS_LONGEST:
+		ret.prefixes = longest_transfer_sequences;
+		break;
+	default:
+		throw runtime_error("Invalid prefixes");
+	}
+	ret.k_max = o.k_max;
+	ret.l = min(o.l, o.k_max);
+	ret.rnd_length = o.rnd_length;
+	ret.seed = o.seed;
+	ret.skip_dup = o.skip_duplicates != 0;
+	ret.philox = o.philox != 0;
+	return ret;
+}
+
+int fail(char const * message) {
+	last_error = message;
+	return HADS_ERROR;
+}
+
+template <typename Word>
+int copy_out(Word const & w, uint32_t * buffer, size_t capacity, size_t * length) {
+	if (!length || (!buffer && capacity > 0)) return fail("No buffer given");
+	*length = w.size();
+	if (w.size() > capacity) {
+		last_error = "The buffer is too small";
+		return HADS_BUFFER_TOO_SMALL;
+	}
+	copy(w.begin(), w.end(), buffer);
+	return HADS_OK;
+}
+
+void check_state(hads_session const * s, size_t state) {
+	if (!s) throw runtime_error("No session given");
+	if (!s->generator.has_hypothesis()) throw runtime_error("There is no machine yet");
+	if (state >= s->generator.hypothesis().graph_size) throw runtime_error("Invalid state");
+}
+}
+
+void hads_default_options(hads_options * options) {
+	if (!options) return;
+	const session_options d;
+	options->mode = HADS_ALL;
+	options->prefixes = HADS_MINIMAL;
+	options->suffixes = HADS_HADS;
+	options->k_max = d.k_max;
+	options->l = d.l;
+	options->rnd_length = d.rnd_length;
+	options->seed = d.seed;
+	options->skip_duplicates = d.skip_dup;
+	options->philox = d.philox;
+}
+
+hads_session * hads_create(const hads_options * options) try {
+	if (!options) {
+		fail("No options given");
+		return nullptr;
+	}
+	return new hads_session(to_session_options(*options));
+} catch (exception const & e) {
+	fail(e.what());
+	return nullptr;
+}
+
+void hads_destroy(hads_session * session) { delete session; }
+
+int hads_set_machine(hads_session * session, size_t states, size_t inputs,
+                     const uint32_t * successors, const uint32_t * outputs) try {
+	if (!session || !successors || !outputs) return fail("No session or machine given");
+	if (states == 0 || inputs == 0) return fail("Empty state or input set");
+	if (states > numeric_limits<state>::max() || inputs > numeric_limits<input>::max())
+		return fail("Too many states or inputs");
+
+	mealy m;
+	m.graph_size = states;
+	m.input_size = inputs;
+	m.graph.assign(states, vector<mealy::edge>(inputs));
+	for (size_t s = 0; s < states; ++s) {
+		for (size_t i = 0; i < inputs; ++i) {
+			const auto t = successors[s * inputs + i];
+			const auto o = outputs[s * inputs + i];
+			if (t == HADS_UNDEFINED) continue;
+			if (t >= states) return fail("Invalid successor");
+			if (o >= numeric_limits<output>::max()) return fail("Invalid output");
+			m.graph[s][i] = mealy::edge(state(t), output(o));
+			m.output_size = max(m.output_size, size_t(o) + 1);
+		}
+	}
+
+	// The session expects state 0 to reach everything (and we do not want to renumber)
+	if (reachable_submachine(m, 0).graph_size != states)
+		return fail("Not all states are reachable from state 0");
+
+	vector<string> names(inputs);
+	for (size_t i = 0; i < inputs; ++i) names[i] = to_string(i);
+	session->generator.set_hypothesis(move(m), move(names));
+	session->pending.clear();
+	session->finished = false;
+	return HADS_OK;
+} catch (exception const & e) {
+	return fail(e.what());
+}
+
+int hads_next_test(hads_session * session, uint32_t * buffer, size_t capacity,
+                   size_t * length) try {
+	if (!session) return fail("No session given");
+
+	if (session->pending.empty() && !session->finished) {
+		const auto n = session->generator.next_tests(
+		    chunk_size, [session](word const & w) { session->pending.push_back(w); });
+		session->finished = n < chunk_size;
+	}
+	if (session->pending.empty()) return 0;
+
+	const auto ret = copy_out(session->pending.front(), buffer, capacity, length);
+	if (ret != HADS_OK) return ret;
+	session->pending.pop_front();
+	return 1;
+} catch (exception const & e) {
+	return fail(e.what());
+}
+
+int hads_transfer_sequence(const hads_session * session, size_t s, uint32_t * buffer,
+                           size_t capacity, size_t * length) try {
+	check_state(session, s);
+	return copy_out(session->generator.transfer()[state(s)], buffer, capacity, length);
+} catch (exception const & e) {
+	return fail(e.what());
+}
+
+int hads_separating_set_size(const hads_session * session, size_t s) try {
+	check_state(session, s);
+	return int(session->generator.separating()[state(s)].local_suffixes.size());
+} catch (exception const & e) {
+	return fail(e.what());
+}
+
+int hads_separating_sequence(const hads_session * session, size_t s, size_t j, uint32_t * buffer,
+                             size_t capacity, size_t * length) try {
+	check_state(session, s);
+	const auto & family = session->generator.separating();
+	const auto & suffixes = family[state(s)].local_suffixes;
+	if (j >= suffixes.size()) return fail("Invalid index of separating sequence");
+	return copy_out(family.suffixes[suffixes[j]], buffer, capacity, length);
+} catch (exception const & e) {
+	return fail(e.what());
+}
+
+const char * hads_last_error(void) { return last_error.c_str(); }
@@ -0,0 +1,94 @@
+#ifndef HYBRID_ADS_H
+#define HYBRID_ADS_H
+
+/*
+ * A C interface to the test generation, for use in other runtimes (e.g. via JNI or ctypes).
+ * Machines are given as integer arrays, and tests are pulled one by one into buffers of the
+ * caller, so no text is produced or parsed.
+ *
+ * All functions returning an int return HADS_OK (or a count) on success and a negative value on
+ * failure, in which case hads_last_error() describes the problem. A session should only be used
+ * by one thread at a time.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+	HADS_OK = 0,
+	HADS_ERROR = -1,
+	HADS_BUFFER_TOO_SMALL = -2
+};
+
+/* A successor for undefined transitions */
+#define HADS_UNDEFINED UINT32_MAX
+
+enum hads_mode { HADS_ALL = 0, HADS_FIXED = 1, HADS_RANDOM = 2 };
+enum hads_prefixes { HADS_MINIMAL = 0, HADS_LEXMIN = 1, HADS_BUGGY = 2, HADS_LONGEST = 3 };
+enum hads_suffixes { HADS_HADS = 0, HADS_HSI = 1, HADS_NONE = 2 };
+
+/* The options, as the command line options of main */
+typedef struct hads_options {
+	int mode;            /* enum hads_mode (-m) */
+	int prefixes;        /* enum hads_prefixes (-p) */
+	int suffixes;        /* enum hads_suffixes (-s) */
+	size_t k_max;        /* -k */
+	size_t l;            /* -l */
+	size_t rnd_length;   /* -r */
+	unsigned long seed;  /* -x, 0 for a random seed */
+	int skip_duplicates; /* 0 for -e */
+	int philox;          /* 1 for -g philox */
+} hads_options;
+
+typedef struct hads_session hads_session;
+
+/* Fills options with the defaults of main */
+void hads_default_options(hads_options * options);
+
+/* Creates a session, NULL on failure. Destroy it with hads_destroy. */
+hads_session * hads_create(const hads_options * options);
+void hads_destroy(hads_session * session);
+
+/*
+ * Sets the (next) hypothesis. The machine has states 0, ..., states - 1 (0 is initial) and inputs
+ * 0, ..., inputs - 1. The transition from s on i goes to successors[s * inputs + i], with output
+ * outputs[s * inputs + i]. A successor HADS_UNDEFINED marks an undefined transition (the machine
+ * may be partial). All states should be reachable from state 0. The test suite starts
+ * over, but tests given for earlier hypotheses are not given again (unless skip_duplicates is 0).
+ */
+int hads_set_machine(hads_session * session, size_t states, size_t inputs,
+                     const uint32_t * successors, const uint32_t * outputs);
+
+/*
+ * Pulls the next test into buffer, and stores its length in *length. Returns 1 if a test is given,
+ * 0 if the test suite is finished. If the test does not fit, HADS_BUFFER_TOO_SMALL is returned and
+ * *length is the length needed; the test is then kept for the next call.
+ */
+int hads_next_test(hads_session * session, uint32_t * buffer, size_t capacity, size_t * length);
+
+/*
+ * The transfer sequence (prefix) for state s. Returns HADS_OK, or HADS_BUFFER_TOO_SMALL as above.
+ * States are numbered as in hads_set_machine.
+ */
+int hads_transfer_sequence(const hads_session * session, size_t s, uint32_t * buffer,
+                           size_t capacity, size_t * length);
+
+/* The number of separating sequences (suffixes) of state s, or a negative value on failure */
+int hads_separating_set_size(const hads_session * session, size_t s);
+
+/* The j-th separating sequence of state s, as hads_transfer_sequence */
+int hads_separating_sequence(const hads_session * session, size_t s, size_t j, uint32_t * buffer,
+                             size_t capacity, size_t * length);
+
+/* A description of the last failure in this thread, valid until the next failure */
+const char * hads_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -16,6 +16,7 @@ adaptive_distinguishing_sequence create_adaptive_distinguishing_sequence(const r
 	const auto & root = splitting_tree.root;
 	const auto & succession = splitting_tree.successor_cache;
 	const auto N = root.states.size();
+	const splitting_tree_index index(root);
 
 	adaptive_distinguishing_sequence sequence(N, 0);
 
@@ -28,43 +29,35 @@ adaptive_distinguishing_sequence create_adaptive_distinguishing_sequence(const r
 
 		if(node.CI.size() < 2) continue;
 
-		vector<bool> states(N, false);
-		for(auto && state : node.CI){
-			states[state.first] = true;
-		}
-
-		const auto & oboom = lca(root, [&states](state state) -> bool{
-			return states[state];
-		});
-
-		if(oboom.children.empty()) continue;
-
-		node.w = oboom.separator;
-		for(auto && c : oboom.children){
-			adaptive_distinguishing_sequence new_c(0, node.depth + 1);
-
-			size_t i = 0;
-			size_t j = 0;
-
-			while(i < node.CI.size() && j < c.states.size()){
-				if(node.CI[i].first < c.states[j]) {
-					i++;
-				} else if(node.CI[i].first > c.states[j]) {
-					j++;
-				} else {
-					const auto curr = succession[oboom.depth][node.CI[i].first];
-					const auto init = node.CI[i].second;
-					new_c.CI.push_back({curr, init});
-					i++;
-					j++;
-				}
-			}
+		// After an undefined transition (in a partial machine) we cannot go on
+		if(node.CI.front().first == state(-1)) continue;
 
-			// FIXME: this should/could be done without sorting...
-			sort(begin(new_c.CI), end(new_c.CI));
+		// The leaves are numbered in pre-order, so the lca of all current states is the lca of the
+		// first and last leaf. This is O(|CI| + depth), instead of a walk up for every state.
+		auto first = index.leaf[node.CI.front().first];
+		auto last = first;
+		for (auto && p : node.CI) {
+			first = min(first, index.leaf[p.first]);
+			last = max(last, index.leaf[p.first]);
+		}
+		const auto lca = index.lca(first, last);
+		const auto oboom = index.nodes[lca];
+
+		if(oboom->children.empty()) continue;
+
+		// Distribute the states over the children of the lca, and apply the separator
+		node.w = oboom->separator;
+		vector<adaptive_distinguishing_sequence> children(oboom->children.size(),
+		                                                  adaptive_distinguishing_sequence(0, node.depth + 1));
+		for (auto && p : node.CI) {
+			const auto curr = succession[oboom->depth][p.first];
+			const auto init = p.second;
+			children[index.child_towards(lca, p.first)].CI.push_back({curr, init});
+		}
 
-			if(!new_c.CI.empty()){
-				node.children.push_back(move(new_c));
+		for (auto && c : children) {
+			if(!c.CI.empty()){
+				node.children.push_back(move(c));
 			}
 		}
 
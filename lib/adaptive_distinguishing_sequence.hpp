@@ -15,7 +15,7 @@
 struct adaptive_distinguishing_sequence {
 	adaptive_distinguishing_sequence(size_t N, size_t depth);
 
-	// current, initial
+	// current, initial (in no particular order)
 	std::vector<std::pair<state, state>> CI;
 	std::vector<adaptive_distinguishing_sequence> children;
 	word w;
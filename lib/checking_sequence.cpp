@@ -0,0 +1,225 @@
+#include "checking_sequence.hpp"
+#include "mealy.hpp"
+#include "separating_family.hpp"
+#include "test_suite.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+synchronizing_sequence create_synchronizing_sequence(const mealy & machine, size_t max_pairs) {
+	synchronizing_sequence ret;
+	const auto N = machine.graph_size;
+	const auto P = machine.input_size;
+	if (N == 0 || !is_complete(machine)) return ret;
+
+	// If all inputs are permutations, states can never be merged (a quick check for a common case)
+	bool all_permutations = true;
+	vector<bool> hit(N);
+	for (input i = 0; i < P && all_permutations; ++i) {
+		hit.assign(N, false);
+		for (state s = 0; s < N; ++s) {
+			const auto t = apply(machine, s, i).to;
+			if (hit[t]) all_permutations = false;
+			hit[t] = true;
+		}
+	}
+	if (N > 1 && all_permutations) return ret;
+
+	// the states in which we can be after the sequence so far
+	vector<state> current(N);
+	for (state s = 0; s < N; ++s) current[s] = s;
+	vector<bool> in_next(N, false);
+
+	// a pair {s, t} with s < t is stored as s * N + t
+	const auto key = [N](state s, state t) { return s < t ? s * N + t : t * N + s; };
+
+	word w;
+	while (current.size() > 1) {
+		// bfs in the pair graph, until two states are merged
+		unordered_map<size_t, pair<size_t, input>> parent;
+		queue<pair<state, state>> work;
+		const auto root = key(current[0], current[1]);
+		parent[root] = {root, 0};
+		work.emplace(current[0], current[1]);
+
+		bool merged = false;
+		size_t last = root;
+		input last_input = 0;
+		while (!work.empty() && !merged) {
+			if (parent.size() > max_pairs) return ret;
+
+			const auto p = work.front();
+			work.pop();
+			const auto k = key(p.first, p.second);
+			for (input i = 0; i < P; ++i) {
+				const auto s = apply(machine, p.first, i).to;
+				const auto t = apply(machine, p.second, i).to;
+				if (s == t) {
+					merged = true;
+					last = k;
+					last_input = i;
+					break;
+				}
+				if (parent.emplace(key(s, t), make_pair(k, i)).second) work.emplace(s, t);
+			}
+		}
+
+		// not even these two states can be merged
+		if (!merged) return ret;
+
+		w.assign(1, last_input);
+		for (auto k = last; k != root; k = parent[k].first) w.push_back(parent[k].second);
+		reverse(w.begin(), w.end());
+		ret.sequence.insert(ret.sequence.end(), w.begin(), w.end());
+
+		vector<state> next;
+		for (auto s : current) {
+			const auto t = apply(machine, s, w.begin(), w.end()).to;
+			if (in_next[t]) continue;
+			in_next[t] = true;
+			next.push_back(t);
+		}
+		for (auto t : next) in_next[t] = false;
+		current.swap(next);
+	}
+
+	ret.exists = true;
+	ret.target = current[0];
+	return ret;
+}
+
+void checking_sequences(const mealy & specification, const separating_family & separating_family,
+                        size_t k_max, const synchronizing_sequence & start, const writer & output) {
+	const auto N = specification.graph_size;
+	const auto P = specification.input_size;
+
+	// number of middle sequences of length k
+	vector<size_t> middles(k_max, 1);
+	for (size_t k = 1; k < k_max; ++k) middles[k] = middles[k - 1] * P;
+
+	// Middle number m of length k, in the order of all_seqs (first symbol is most significant)
+	word middle;
+	const auto decode = [&middle, P](size_t k, size_t m) {
+		middle.resize(k);
+		for (size_t d = k; d-- > 0;) {
+			middle[d] = m % P;
+			m /= P;
+		}
+	};
+
+	// For every state the next test to do from that state: (length, middle, suffix)
+	struct cursor {
+		size_t k = 0;
+		size_t m = 0;
+		size_t j = 0;
+	};
+	vector<cursor> cursors(N);
+
+	// Moves the cursor of s to an actual test, returns false if s has no tests left. On success, the
+	// middle sequence is decoded and the state it leads to is returned in t.
+	const auto next_test = [&](state s, state & t) {
+		auto & c = cursors[s];
+		while (c.k < k_max) {
+			if (c.m == middles[c.k]) {
+				c = {c.k + 1, 0, 0};
+				continue;
+			}
+			decode(c.k, c.m);
+			t = try_apply(specification, s, middle.begin(), middle.end()).to;
+			if (t != state(-1) && c.j < separating_family[t].local_suffixes.size()) return true;
+			c.m++;
+			c.j = 0;
+		}
+		return false;
+	};
+
+	vector<bool> has_tests(N, false);
+	size_t remaining = 0;
+	for (state s = 0; s < N; ++s) {
+		state t;
+		has_tests[s] = next_test(s, t);
+		if (has_tests[s]) remaining++;
+	}
+
+	// For the bfs to the nearest state with tests left
+	vector<size_t> visited(N, 0);
+	size_t stamp = 0;
+	vector<state> parent(N);
+	vector<input> via(N);
+	queue<state> work;
+	word transfer;
+	const auto nearest_with_tests = [&](state from) {
+		stamp++;
+		work = {};
+		work.push(from);
+		visited[from] = stamp;
+		while (!work.empty()) {
+			const auto u = work.front();
+			work.pop();
+			if (has_tests[u]) {
+				transfer.clear();
+				for (auto v = u; v != from; v = parent[v]) transfer.push_back(via[v]);
+				reverse(transfer.begin(), transfer.end());
+				return u;
+			}
+			for (input i = 0; i < P; ++i) {
+				const auto v = apply(specification, u, i).to;
+				if (v == state(-1) || visited[v] == stamp) continue;
+				visited[v] = stamp;
+				parent[v] = u;
+				via[v] = i;
+				work.push(v);
+			}
+		}
+		return state(-1);
+	};
+
+	state current = 0;
+	if (start.exists) {
+		output.apply(start.sequence);
+		current = start.target;
+	}
+
+	while (remaining > 0) {
+		// After an undefined transition (in a partial machine) we also need a reset
+		if (current == state(-1)) {
+			if (!output.reset()) return;
+			current = 0;
+		}
+
+		if (!has_tests[current]) {
+			const auto target = nearest_with_tests(current);
+			if (target == state(-1)) {
+				// Unreachable, so we need a reset
+				if (!output.reset()) return;
+				current = 0;
+				continue;
+			}
+			output.apply(transfer);
+			current = target;
+		}
+
+		state t;
+		next_test(current, t);
+		auto & c = cursors[current];
+		const auto suffix = separating_family.suffixes[separating_family[t].local_suffixes[c.j]];
+		output.apply(middle);
+		output.apply(suffix);
+		// The suffix may end with an undefined transition (in a partial machine)
+		const auto end = try_apply(specification, t, suffix.begin(), suffix.end()).to;
+
+		c.j++;
+		if (!next_test(current, t)) {
+			has_tests[current] = false;
+			remaining--;
+		}
+		current = end;
+	}
+
+	output.reset();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "types.hpp"
+
+struct mealy;
+struct separating_family;
+struct writer;
+
+/// \brief A word which brings every state of the machine to one and the same state (if it exists).
+struct synchronizing_sequence {
+	bool exists = false;
+	word sequence;
+	state target = 0; // the state in which all states end up
+};
+
+/// \brief Computes a synchronizing sequence greedily (Eppstein): repeatedly merge two states of the
+/// current set with a shortest merging word. Searching pairs is quadratic in the worst case, so we
+/// give up after visiting \p max_pairs pairs for a single merge (and then report it does not exist).
+/// For partial machines we do not look for one.
+synchronizing_sequence create_synchronizing_sequence(mealy const & machine, size_t max_pairs);
+
+/// \brief Chains the tests of test() (with mid sequences < \p k_max) into a few long sequences, to
+/// be applied without resets. Instead of a prefix from the initial state, a test from state s is
+/// preceded by a shortest transfer from the state in which the previous test ended. We always go to
+/// the nearest state which still has tests. The chain is only broken (by output.reset()) when the
+/// remaining tests are unreachable (or a test ends with an undefined transition), the next sequence
+/// then starts after a reset.
+/// If \p start is given (it exists), the first sequence starts with it, so that the first sequence
+/// does not need a reset either.
+void checking_sequences(mealy const & specification, separating_family const & separating_family,
+                        size_t k_max, synchronizing_sequence const & start, writer const & output);
@@ -0,0 +1,187 @@
+#include "checkpoint.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/sockios.h>
+#endif
+#endif
+
+using namespace std;
+
+static const char header[] = "hybrid-ads checkpoint 4"; // version 4 keeps all unconfirmed tests
+
+// FNV-1a, which is simple and good enough to detect a different specification
+static void add_to_hash(uint64_t & hash, uint64_t x) {
+	for (int i = 0; i < 8; ++i) {
+		hash ^= (x >> (8 * i)) & 0xff;
+		hash *= 1099511628211ull;
+	}
+}
+
+uint64_t fingerprint(const mealy & m, const vector<string> & inputs) {
+	uint64_t hash = 14695981039346656037ull;
+	add_to_hash(hash, m.graph_size);
+	add_to_hash(hash, m.input_size);
+	add_to_hash(hash, m.output_size);
+	for (auto const & row : m.graph) {
+		add_to_hash(hash, row.size());
+		for (auto const & e : row) {
+			add_to_hash(hash, e.to);
+			add_to_hash(hash, e.out);
+		}
+	}
+	for (auto const & name : inputs) {
+		add_to_hash(hash, name.size());
+		for (auto c : name) add_to_hash(hash, uint64_t(c));
+	}
+	return hash;
+}
+
+void write_checkpoint(const checkpoint & c, const trie<input> & t, const string & filename) {
+	const auto temporary = filename + ".tmp";
+	{
+		ofstream out(temporary);
+		out << header << '\n';
+		out << "options " << c.options << '\n';
+		out << "machine " << c.machine << '\n';
+		out << "seeds " << c.seeds.size();
+		for (auto s : c.seeds) out << ' ' << s;
+		out << '\n';
+		out << "stage " << int(c.stage) << '\n';
+		out << "position " << c.position << '\n';
+		out << "cursor " << c.cursor.unit << ' ' << c.cursor.suffix << '\n';
+		out << "generator " << c.generator << '\n';
+		out << "pending " << c.pending.size() << '\n';
+		for (auto const & w : c.pending) {
+			out << w.size();
+			for (auto x : w) out << ' ' << x;
+			out << '\n';
+		}
+		t.write(out);
+		if (!out) throw runtime_error("Could not write checkpoint " + temporary);
+	}
+
+	// On windows rename does not overwrite
+	remove(filename.c_str());
+	if (rename(temporary.c_str(), filename.c_str()) != 0)
+		throw runtime_error("Could not move checkpoint to " + filename);
+}
+
+// Whether fd is read by another process (a pipe or socket), and not a file or terminal
+static bool has_consumer(int fd) {
+#ifndef _WIN32
+	struct stat info;
+	if (fstat(fd, &info) != 0) return true;
+	return S_ISFIFO(info.st_mode) || S_ISSOCK(info.st_mode);
+#else
+	(void)fd;
+	return false;
+#endif
+}
+
+// The bytes written to the pipe or socket fd which are not read yet. Returns false when we cannot
+// tell (then nothing is confirmed).
+static bool unread_bytes(int fd, uint64_t & unread) {
+	int n = 0;
+#if defined(FIONREAD) && defined(SIOCOUTQ)
+	struct stat info;
+	if (fstat(fd, &info) != 0) return false;
+	if (ioctl(fd, S_ISSOCK(info.st_mode) ? SIOCOUTQ : FIONREAD, &n) != 0) return false;
+#elif defined(FIONREAD)
+	struct stat info;
+	if (fstat(fd, &info) != 0 || S_ISSOCK(info.st_mode)) return false;
+	if (ioctl(fd, FIONREAD, &n) != 0) return false;
+#else
+	(void)fd;
+	return false;
+#endif
+	unread = uint64_t(n);
+	return true;
+}
+
+unconfirmed_tests::unconfirmed_tests(int fd_, size_t read_ahead_)
+: fd(fd_), read_ahead(read_ahead_), consumer(has_consumer(fd_)) {}
+
+void unconfirmed_tests::written(const word & w, size_t bytes, bool ok) {
+	// What a file or terminal accepts is there, only a failed test is kept
+	if (!consumer) {
+		if (!ok) tests.emplace_back(0, w);
+		return;
+	}
+
+	// When the consumer is gone, the pipe still tells how much it did not read. A failed test
+	// (and everything after it) is never confirmed.
+	if (ok) total += bytes;
+	if (!ok || (!tests.empty() && tests.front().first + read_ahead <= total)) confirm();
+	tests.emplace_back(ok ? total : uint64_t(-1) - read_ahead, w);
+}
+
+void unconfirmed_tests::confirm() {
+	uint64_t unread = 0;
+	if (!unread_bytes(fd, unread)) return;
+	const auto read = unread < total ? total - unread : 0;
+	while (!tests.empty() && tests.front().first + read_ahead <= read) tests.pop_front();
+}
+
+vector<word> unconfirmed_tests::words() const {
+	vector<word> ret;
+	ret.reserve(tests.size());
+	for (auto const & t : tests) ret.push_back(t.second);
+	return ret;
+}
+
+// Reads a line starting with key, returns the rest of the line
+static string read_field(istream & in, const string & key) {
+	string line;
+	getline(in, line);
+	if (line.compare(0, key.size() + 1, key + ' ') != 0)
+		throw runtime_error("Checkpoint is missing " + key);
+	return line.substr(key.size() + 1);
+}
+
+checkpoint read_checkpoint(const string & filename, trie<input> & t) {
+	ifstream in(filename);
+	if (!in) throw runtime_error("Could not open checkpoint " + filename);
+
+	string line;
+	getline(in, line);
+	if (line != header) throw runtime_error(filename + " is not a checkpoint");
+
+	checkpoint c;
+	c.options = read_field(in, "options");
+	c.machine = stoull(read_field(in, "machine"));
+
+	stringstream seeds(read_field(in, "seeds"));
+	size_t number_of_seeds = 0;
+	seeds >> number_of_seeds;
+	c.seeds.resize(number_of_seeds);
+	for (auto & s : c.seeds) seeds >> s;
+
+	c.stage = checkpoint::stage_t(stoi(read_field(in, "stage")));
+	c.position = stoul(read_field(in, "position"));
+
+	stringstream cursor(read_field(in, "cursor"));
+	cursor >> c.cursor.unit >> c.cursor.suffix;
+
+	c.generator = read_field(in, "generator");
+
+	c.pending.resize(stoul(read_field(in, "pending")));
+	for (auto & w : c.pending) {
+		size_t size = 0;
+		in >> size;
+		w.resize(size);
+		for (auto & x : w) in >> x;
+	}
+
+	if (!seeds || !cursor || !in) throw runtime_error("Could not parse checkpoint " + filename);
+
+	t.read(in);
+	return c;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "mealy.hpp"
+#include "test_suite.hpp"
+#include "trie.hpp"
+#include "types.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// \brief The progress of a (long) test suite generation, such that it can be resumed.
+/// Together with the trie of the generated tests, this is written to a checkpoint file.
+struct checkpoint {
+	enum stage_t { FIRST_PART, SECOND_PART, RANDOM_PART, DONE };
+
+	std::string options;               // description of the options, to detect mismatches
+	std::uint64_t machine = 0;         // fingerprint of the specification, idem
+	std::vector<uint_fast32_t> seeds;  // the seeds of all the random structures
+	stage_t stage = FIRST_PART;
+	size_t position = 0;               // index in the (shuffled) first part
+	test_cursor cursor;                // position in the second part
+	std::string generator;             // state of the generator of the random part
+	std::vector<word> pending;         // tests which may not have been read, written first on resume
+};
+
+/// \brief Keeps the tests written to file descriptor \p fd which may not have been read by the
+/// consumer yet, so that a checkpoint can write them again. Bytes still in a pipe (or in the send
+/// queue of a socket) are not read. Besides, a test only counts as read when \p read_ahead more
+/// bytes are read after it, as a consumer may read a whole block and then stop (e.g. head).
+/// So after a resume, some tests are repeated, but none are lost. A file or terminal has no
+/// consumer, there a test is read when it is written.
+struct unconfirmed_tests {
+	explicit unconfirmed_tests(int fd, size_t read_ahead = 1 << 16);
+
+	/// \brief Records the test \p w, which took \p bytes of the output (and was flushed). Call
+	/// this also when writing failed, then the test is kept.
+	void written(word const & w, size_t bytes, bool ok);
+
+	/// \brief The tests which may not have been read, in the order they were written
+	std::vector<word> words() const;
+
+  private:
+	void confirm();
+
+	int fd;
+	size_t read_ahead;
+	bool consumer;                                    // a pipe or socket, not a file
+	std::uint64_t total = 0;                          // bytes written
+	std::deque<std::pair<std::uint64_t, word>> tests; // end (in bytes) and test
+};
+
+/// \brief A hash of the machine \p m (after all transformations) and the names of its \p inputs.
+/// A checkpoint only fits a specification with the same fingerprint.
+std::uint64_t fingerprint(mealy const & m, std::vector<std::string> const & inputs);
+
+/// \brief Writes \p c and the trie \p t to \p filename (via a temporary file, so that a crash
+/// never leaves a broken checkpoint).
+void write_checkpoint(checkpoint const & c, trie<input> const & t, std::string const & filename);
+
+/// \brief Reads a checkpoint from \p filename, the trie is stored in \p t
+checkpoint read_checkpoint(std::string const & filename, trie<input> & t);
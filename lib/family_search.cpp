@@ -0,0 +1,99 @@
+#include "family_search.hpp"
+#include "adaptive_distinguishing_sequence.hpp"
+#include "mealy.hpp"
+#include "shortest_separators.hpp"
+#include "splitting_tree.hpp"
+#include "suite_size.hpp"
+#include "transfer_sequences.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+separating_family search_separating_family(const mealy & m, const transfer_sequences & prefixes,
+                                           size_t k_max, const family_search_options & opts,
+                                           uint_fast32_t hopcroft_seed, uint_fast32_t ly_seed) {
+	// Without the ADS and with the shortest separators, nothing is randomized, and every try
+	// would give the same family
+	const bool randomized = opts.use_distinguishing_sequence || !opts.shortest_separators;
+	const auto tries = randomized ? max<size_t>(opts.tries, 1) : 1;
+
+	// The shortest separators do not depend on a seed, so they are shared by all tries
+	const auto shortest = opts.shortest_separators ? create_shortest_splitting_tree(m)
+	                                               : result(0);
+
+	const auto construct = [&](size_t i) {
+		uint_fast32_t seeds[2] = {hopcroft_seed, ly_seed};
+		if (i > 0) {
+			seed_seq s{hopcroft_seed, ly_seed, uint_fast32_t(i)};
+			s.generate(begin(seeds), end(seeds));
+		}
+
+		const auto hopcroft = opts.shortest_separators
+		                          ? result(0)
+		                          : create_splitting_tree(m, randomized_hopcroft_style, seeds[0]);
+		const auto lee_yannakakis =
+		    opts.use_distinguishing_sequence
+		        ? create_splitting_tree(m, randomized_lee_yannakakis_style, seeds[1])
+		        : result(m.graph_size);
+		const auto sequence = create_adaptive_distinguishing_sequence(lee_yannakakis);
+		return create_separating_family(sequence, opts.shortest_separators ? shortest.root
+		                                                                   : hopcroft.root);
+	};
+
+	const auto score = [&](separating_family const & family) {
+		double symbols = 0;
+		for (auto const & size : count_tests(m, prefixes, family, k_max)) symbols += size.symbols;
+		return symbols;
+	};
+
+	// Every thread keeps its own best, the tries are handed out in order
+	struct candidate {
+		double symbols = 0;
+		size_t index = size_t(-1);
+		separating_family family;
+	};
+
+	// Smaller is better, an empty candidate is worst
+	const auto better = [](double symbols, size_t index, candidate const & c) {
+		if (c.index == size_t(-1)) return true;
+		return symbols < c.symbols || (symbols == c.symbols && index < c.index);
+	};
+
+	const auto hardware = max<size_t>(thread::hardware_concurrency(), 1);
+	const auto thread_count = min(tries, opts.threads == 0 ? hardware : opts.threads);
+	vector<candidate> best(thread_count);
+	vector<exception_ptr> errors(thread_count);
+	atomic<size_t> next(0);
+
+	const auto work = [&](size_t t) {
+		try {
+			for (size_t i = next++; i < tries; i = next++) {
+				auto family = construct(i);
+				const auto symbols = score(family);
+				if (better(symbols, i, best[t])) best[t] = {symbols, i, move(family)};
+			}
+		} catch (...) {
+			errors[t] = current_exception();
+		}
+	};
+
+	vector<thread> threads;
+	for (size_t t = 1; t < thread_count; ++t) threads.emplace_back(work, t);
+	work(0);
+	for (auto & t : threads) t.join();
+
+	for (auto const & e : errors)
+		if (e) rethrow_exception(e);
+
+	candidate winner;
+	for (auto & c : best)
+		if (c.index != size_t(-1) && better(c.symbols, c.index, winner)) winner = move(c);
+	return move(winner.family);
+}
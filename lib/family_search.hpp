@@ -0,0 +1,31 @@
+#pragma once
+
+#include "separating_family.hpp"
+
+#include <cstdint>
+
+struct mealy;
+struct transfer_sequences;
+
+/// \brief The options for search_separating_family
+struct family_search_options {
+	size_t tries = 1;                        // the number of randomized constructions
+	size_t threads = 0;                      // 0 for the number of cores
+	bool use_distinguishing_sequence = true; // hads, otherwise hsi
+	bool shortest_separators = false;        // instead of the randomized Hopcroft tree
+};
+
+///
+/// \brief Constructs several separating families with the randomized splitting trees, and returns
+/// the one for which test() gives the fewest symbols (with \p prefixes and middles shorter than
+/// \p k_max, as computed by count_tests). The first try uses \p hopcroft_seed and \p ly_seed
+/// themselves, so the result is never larger than the single construction with these seeds. The
+/// tries are done in parallel, but the result only depends on the seeds (ties go to the first try).
+/// With hsi and the shortest separators nothing depends on the seeds, so there is a single try.
+///
+/// We keep a whole family, instead of combining the best sets of different families, as the sets
+/// have to be harmonized (share prefixes) with each other.
+///
+separating_family search_separating_family(mealy const & m, transfer_sequences const & prefixes,
+                                           size_t k_max, family_search_options const & opts,
+                                           uint_fast32_t hopcroft_seed, uint_fast32_t ly_seed);
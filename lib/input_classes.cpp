@@ -0,0 +1,55 @@
+#include "input_classes.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+input_classes merge_identical_inputs(const mealy & machine) {
+	const auto N = machine.graph_size;
+	const auto P = machine.input_size;
+
+	const auto column_less = [&machine, N](input i, input j) {
+		for (state s = 0; s < N; ++s) {
+			const auto & x = machine.graph[s][i];
+			const auto & y = machine.graph[s][j];
+			if (x.to != y.to) return x.to < y.to;
+			if (x.out != y.out) return x.out < y.out;
+		}
+		return false;
+	};
+
+	// After sorting, identical columns are adjacent (and still in order of their index)
+	vector<input> order(P);
+	iota(order.begin(), order.end(), 0);
+	stable_sort(order.begin(), order.end(), column_less);
+
+	vector<input> class_of(P);
+	vector<input> first(P);
+	for (size_t n = 0; n < P; ++n) {
+		const bool same = n > 0 && !column_less(order[n - 1], order[n]);
+		first[order[n]] = same ? first[order[n - 1]] : order[n];
+	}
+
+	input_classes ret;
+	for (input i = 0; i < P; ++i) {
+		if (first[i] == i) {
+			class_of[i] = ret.members.size();
+			ret.members.emplace_back();
+		} else {
+			class_of[i] = class_of[first[i]];
+		}
+		ret.members[class_of[i]].push_back(i);
+	}
+
+	auto & m = ret.machine;
+	m.graph_size = N;
+	m.input_size = ret.members.size();
+	m.output_size = machine.output_size;
+	m.graph.resize(N);
+	for (state s = 0; s < N; ++s) {
+		m.graph[s].reserve(m.input_size);
+		for (auto && c : ret.members) m.graph[s].push_back(machine.graph[s][c[0]]);
+	}
+	return ret;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "mealy.hpp"
+#include "types.hpp"
+
+#include <vector>
+
+/// \brief The inputs of a machine, grouped into classes of inputs which give the same output and
+/// successor in every state, and the machine on these classes.
+struct input_classes {
+	mealy machine;                           // its inputs are the classes
+	std::vector<std::vector<input>> members; // the inputs of every class, the first represents it
+};
+
+/// \brief Merges the inputs with identical columns in the transition table. Classes are numbered
+/// by their first input, so without identical inputs the machine stays the same. Takes
+/// O(N P log P) time.
+input_classes merge_identical_inputs(mealy const & machine);
@@ -4,6 +4,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 /*
@@ -31,6 +32,41 @@ struct mealy {
 	size_t output_size = 0;
 };
 
+/// \brief The transitions of a machine in reverse, in compressed sparse row form. The predecessors
+/// of state t are the (input, state) pairs in [offsets[t], offsets[t+1]) of edges. Built once, in
+/// linear time, and shared by all algorithms going backwards.
+struct predecessor_index {
+	std::vector<size_t> offsets;
+	std::vector<std::pair<input, state>> edges;
+
+	size_t size(state t) const { return offsets[t + 1] - offsets[t]; }
+	std::pair<input, state> const & operator()(state t, size_t j) const {
+		return edges[offsets[t] + j];
+	}
+};
+
+inline predecessor_index create_predecessor_index(mealy const & m) {
+	predecessor_index ret;
+	ret.offsets.assign(m.graph_size + 1, 0);
+	for (state s = 0; s < m.graph_size; ++s) {
+		for (auto && e : m.graph[s]) {
+			if (e.to != state(-1)) ret.offsets[e.to + 1]++;
+		}
+	}
+	for (state t = 0; t < m.graph_size; ++t) ret.offsets[t + 1] += ret.offsets[t];
+
+	// Fill per state, ordered by the source state and input
+	ret.edges.resize(ret.offsets.back());
+	auto position = ret.offsets;
+	for (state s = 0; s < m.graph_size; ++s) {
+		for (input i = 0; i < m.graph[s].size(); ++i) {
+			const auto t = m.graph[s][i].to;
+			if (t != state(-1)) ret.edges[position[t]++] = {i, s};
+		}
+	}
+	return ret;
+}
+
 inline bool is_complete(const mealy & m){
 	for(state n = 0; n < m.graph_size; ++n){
 		if(m.graph[n].size() != m.input_size) return false;
@@ -59,3 +95,17 @@ mealy::edge apply(mealy const & m, state state, Iterator b, Iterator e){
 	}
 	return ret;
 }
+
+/// \brief Same as apply, but also for partial machines: the result is the undefined edge (to is
+/// state(-1)) as soon as the word leaves the defined transitions. The rows should be complete
+/// (undefined transitions are stored as undefined edges), as reachable_submachine makes them.
+template <typename Iterator>
+mealy::edge try_apply(mealy const & m, state state, Iterator b, Iterator e){
+	mealy::edge ret;
+	ret.to = state;
+	while(b != e){
+		ret = apply(m, ret.to, *b++);
+		if (ret.to == ::state(-1)) return ret;
+	}
+	return ret;
+}
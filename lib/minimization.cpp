@@ -0,0 +1,132 @@
+#include "minimization.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+quotient minimize(const mealy & machine) {
+	const auto N = machine.graph_size;
+	const auto P = machine.input_size;
+
+	// The partition is kept in one array, in which every block is a range. Marked states are
+	// moved to the front of their block, so that a split is only a change of the ranges.
+	struct block_range {
+		size_t begin;
+		size_t end;
+		size_t marked;
+	};
+	vector<state> elements(N);
+	iota(elements.begin(), elements.end(), 0);
+	vector<size_t> position(N);
+	vector<size_t> block(N);
+	vector<block_range> blocks;
+
+	// Initially, states are grouped by their outputs
+	const auto outputs_less = [&machine, P](state s, state t) {
+		for (input i = 0; i < P; ++i) {
+			const auto o = machine.graph[s][i].out;
+			const auto p = machine.graph[t][i].out;
+			if (o != p) return o < p;
+		}
+		return false;
+	};
+	stable_sort(elements.begin(), elements.end(), outputs_less);
+	for (size_t n = 0; n < N; ++n) {
+		if (n == 0 || outputs_less(elements[n - 1], elements[n])) blocks.push_back({n, n, 0});
+		blocks.back().end = n + 1;
+		block[elements[n]] = blocks.size() - 1;
+		position[elements[n]] = n;
+	}
+
+	// Every block is a splitter. When a block splits, the new (smaller) part becomes a splitter
+	// too, the other part already is one or is covered by the splitter it came from.
+	vector<size_t> work(blocks.size());
+	iota(work.begin(), work.end(), 0);
+
+	const auto predecessors = create_predecessor_index(machine);
+	vector<vector<state>> sources(P);
+	vector<state> splitter;
+	vector<size_t> touched;
+
+	const auto mark = [&](state s) {
+		auto & b = blocks[block[s]];
+		const auto p = position[s];
+		if (p < b.begin + b.marked) return;
+		if (b.marked == 0) touched.push_back(block[s]);
+
+		const auto q = b.begin + b.marked++;
+		swap(elements[p], elements[q]);
+		position[elements[p]] = p;
+		position[elements[q]] = q;
+	};
+
+	while (!work.empty()) {
+		const auto b = work.back();
+		work.pop_back();
+
+		// The block may be split while we go through it, so we copy it
+		splitter.assign(elements.begin() + blocks[b].begin, elements.begin() + blocks[b].end);
+		for (auto t : splitter) {
+			for (size_t j = 0; j < predecessors.size(t); ++j) {
+				const auto & e = predecessors(t, j);
+				sources[e.first].push_back(e.second);
+			}
+		}
+
+		for (input i = 0; i < P; ++i) {
+			for (auto s : sources[i]) mark(s);
+			sources[i].clear();
+
+			for (auto c : touched) {
+				auto & r = blocks[c];
+				const auto marked = r.marked;
+				r.marked = 0;
+				if (marked == r.end - r.begin) continue;
+
+				// The smaller part gets a new block
+				const auto middle = r.begin + marked;
+				block_range smaller{r.begin, middle, 0};
+				if (marked <= r.end - middle) {
+					r.begin = middle;
+				} else {
+					smaller = {middle, r.end, 0};
+					r.end = middle;
+				}
+				blocks.push_back(smaller);
+				for (auto n = smaller.begin; n < smaller.end; ++n) block[elements[n]] = blocks.size() - 1;
+				work.push_back(blocks.size() - 1);
+			}
+			touched.clear();
+		}
+	}
+
+	// Number the classes by their first state
+	quotient ret;
+	ret.class_of.assign(N, state(-1));
+	vector<state> number(blocks.size(), state(-1));
+	vector<state> representative;
+	for (state s = 0; s < N; ++s) {
+		auto & c = number[block[s]];
+		if (c == state(-1)) {
+			c = representative.size();
+			representative.push_back(s);
+		}
+		ret.class_of[s] = c;
+	}
+
+	auto & m = ret.machine;
+	m.graph_size = representative.size();
+	m.input_size = P;
+	m.output_size = machine.output_size;
+	m.graph.resize(m.graph_size);
+	for (state c = 0; c < m.graph_size; ++c) {
+		m.graph[c].resize(P);
+		for (input i = 0; i < P; ++i) {
+			const auto e = machine.graph[representative[c]][i];
+			if (e.to == state(-1)) continue;
+			m.graph[c][i] = mealy::edge(ret.class_of[e.to], e.out);
+		}
+	}
+	return ret;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "mealy.hpp"
+#include "types.hpp"
+
+#include <vector>
+
+/// \brief A machine in which equivalent states are merged, and how the original states map to it
+struct quotient {
+	mealy machine;
+	std::vector<state> class_of; // for every original state, the state of machine
+};
+
+/// \brief Merges equivalent states with Hopcroft's partition refinement (O(P N log N)). The
+/// classes are numbered in order of their first state, so state 0 remains state 0. In a partial
+/// machine, an undefined transition counts as a distinct output, so only states with the same
+/// defined inputs are merged.
+quotient minimize(mealy const & machine);
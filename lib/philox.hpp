@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+///
+/// \brief A counter based random number generator (Philox-4x32-10, Salmon et al., "Parallel
+/// random numbers: as easy as 1, 2, 3", 2011). Its output is a function of a key and a counter,
+/// so there is no sequential state: every stream (e.g. the random choices of test number i) can
+/// be generated directly, and independently of the other streams.
+///
+/// Satisfies the UniformRandomBitGenerator concept, so it can be used with the distributions of
+/// <random>. A stream has 2^34 numbers, which is plenty for a single test.
+///
+struct philox {
+	using result_type = std::uint32_t;
+
+	philox(std::uint32_t seed, std::uint64_t stream)
+	: key{{seed, 0}}, counter{{0, std::uint32_t(stream), std::uint32_t(stream >> 32), 0}} {}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()() {
+		if (used == 4) {
+			block = generate(counter, key);
+			counter[3]++;
+			used = 0;
+		}
+		return block[used++];
+	}
+
+	using block_t = std::array<std::uint32_t, 4>;
+	using key_t = std::array<std::uint32_t, 2>;
+
+	/// \brief The bijection itself: ten rounds on the counter, keyed by key
+	static block_t generate(block_t c, key_t k) {
+		for (int round = 0; round < 10; ++round) {
+			const auto p0 = std::uint64_t(0xD2511F53) * c[0];
+			const auto p1 = std::uint64_t(0xCD9E8D57) * c[2];
+			c = {{std::uint32_t(p1 >> 32) ^ c[1] ^ k[0], std::uint32_t(p1),
+			      std::uint32_t(p0 >> 32) ^ c[3] ^ k[1], std::uint32_t(p0)}};
+			k[0] += 0x9E3779B9;
+			k[1] += 0xBB67AE85;
+		}
+		return c;
+	}
+
+  private:
+	key_t key;
+	block_t counter; // [0, 1, 2] identify the stream, [3] is the position in the stream
+	block_t block;
+	int used = 4;
+};
@@ -1,56 +1,56 @@
 #include "reachability.hpp"
 #include "mealy.hpp"
 
-#include <map>
-#include <queue>
+#include <stdexcept>
 #include <vector>
 
 using namespace std;
 
 mealy reachable_submachine(const mealy& in, state start) {
-	using state_out = state;
-	state_out max_state = 0;
-	map<state, state_out> new_state;
-	vector<bool> visited(in.graph_size, false);
-
-	mealy out;
-
-	queue<state> work;
-	work.push(start);
-	while (!work.empty()) {
-		state s = work.front();
-		work.pop();
+	vector<state> old_to_new;
+	return reachable_submachine(in, start, old_to_new);
+}
 
-		if (visited[s]) continue;
-		visited[s] = true;
+mealy reachable_submachine(const mealy& in, state start, vector<state>& old_to_new) {
+	if (start >= in.graph_size) throw runtime_error("Empty state set");
 
-		if (!new_state.count(s)) new_state[s] = max_state++;
-		state_out s2 = new_state[s];
+	// The reachable states in order of discovery, this is also the queue of the bfs
+	old_to_new.assign(in.graph_size, state(-1));
+	vector<state> new_to_old;
+	new_to_old.reserve(in.graph_size);
 
+	old_to_new[start] = 0;
+	new_to_old.push_back(start);
+	for (size_t n = 0; n < new_to_old.size(); ++n) {
+		const state s = new_to_old[n];
 		for (input i = 0; i < in.input_size; ++i) {
-			const auto ret = apply(in, s, i);
-			const output o = ret.out;
-			const state t = ret.to;
-
-			if (!new_state.count(t)) new_state[t] = max_state++;
-			state_out t2 = new_state[t];
-
-			if (out.graph.size() < max_state) out.graph.resize(max_state);
-			if (out.graph[s2].size() < in.input_size) out.graph[s2].resize(in.input_size);
-			out.graph[s2][i] = mealy::edge(t2, o);
+			if (!defined(in, s, i)) continue;
 
-			if (!visited[t]) work.push(t);
+			const state t = in.graph[s][i].to;
+			if (old_to_new[t] != state(-1)) continue;
+			old_to_new[t] = new_to_old.size();
+			new_to_old.push_back(t);
 		}
 	}
 
-	out.graph_size = max_state;
+	mealy out;
+	out.graph_size = new_to_old.size();
 	out.input_size = in.input_size;
 	out.output_size = in.output_size;
+	out.graph.assign(out.graph_size, vector<mealy::edge>(in.input_size));
+	for (state s2 = 0; s2 < out.graph_size; ++s2) {
+		const state s = new_to_old[s2];
+		for (input i = 0; i < in.input_size; ++i) {
+			if (!defined(in, s, i)) continue;
+
+			const auto ret = apply(in, s, i);
+			out.graph[s2][i] = mealy::edge(old_to_new[ret.to], ret.out);
+		}
+	}
 
 	if(out.graph_size == 0) throw runtime_error("Empty state set");
 	if(out.input_size == 0) throw runtime_error("Empty input set");
 	if(out.output_size == 0) throw runtime_error("Empty output set");
-	if(!is_complete(out)) throw runtime_error("Partial machine");
 
 	return out;
 }
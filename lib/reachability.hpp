@@ -2,6 +2,15 @@
 
 #include "types.hpp"
 
+#include <vector>
+
 struct mealy;
 
+/// \brief The part of \p in which is reachable from \p start, renumbered in breadth first order
+/// (so \p start becomes state 0). Throws if the result is empty. The machine may be partial, in
+/// the result every row has all inputs, and undefined transitions are undefined edges.
 mealy reachable_submachine(const mealy& in, state start);
+
+/// \brief Same as above, and also gives the new number of every state of \p in in
+/// \p old_to_new (state(-1) for unreachable states). Linear in the size of \p in.
+mealy reachable_submachine(const mealy& in, state start, std::vector<state>& old_to_new);
@@ -0,0 +1,71 @@
+#include "renumbering.hpp"
+#include "mealy.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+vector<state> cuthill_mckee_order(const mealy & machine, state start) {
+	const auto N = machine.graph_size;
+	if (start >= N) throw runtime_error("Empty state set");
+
+	const auto predecessors = create_predecessor_index(machine);
+	const auto degree = [&](state s) { return machine.graph[s].size() + predecessors.size(s); };
+
+	vector<bool> visited(N, false);
+	vector<state> order;
+	order.reserve(N);
+	vector<state> neighbours;
+
+	visited[start] = true;
+	order.push_back(start);
+	for (size_t n = 0; n < order.size(); ++n) {
+		const auto s = order[n];
+
+		neighbours.clear();
+		for (auto && e : machine.graph[s]) {
+			if (e.to != state(-1) && !visited[e.to]) neighbours.push_back(e.to);
+		}
+		for (size_t j = 0; j < predecessors.size(s); ++j) {
+			const auto t = predecessors(s, j).second;
+			if (!visited[t]) neighbours.push_back(t);
+		}
+
+		// Ties are broken by the old number, to be deterministic
+		sort(neighbours.begin(), neighbours.end(), [&](state x, state y) {
+			const auto dx = degree(x);
+			const auto dy = degree(y);
+			return dx != dy ? dx < dy : x < y;
+		});
+		for (auto t : neighbours) {
+			if (visited[t]) continue;
+			visited[t] = true;
+			order.push_back(t);
+		}
+	}
+
+	return order;
+}
+
+mealy renumber(const mealy & machine, const vector<state> & new_to_old) {
+	vector<state> old_to_new(machine.graph_size, state(-1));
+	for (state s = 0; s < new_to_old.size(); ++s) old_to_new[new_to_old[s]] = s;
+
+	// The rows are allocated in the new order, so that they are in that order in memory too
+	mealy out;
+	out.graph_size = new_to_old.size();
+	out.input_size = machine.input_size;
+	out.output_size = machine.output_size;
+	out.graph.reserve(out.graph_size);
+	for (auto s : new_to_old) {
+		out.graph.emplace_back(machine.graph[s]);
+		for (auto & e : out.graph.back()) {
+			if (e.to == state(-1)) continue;
+			if (old_to_new[e.to] == state(-1))
+				throw runtime_error("The new numbering does not contain all states");
+			e.to = old_to_new[e.to];
+		}
+	}
+	return out;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <vector>
+
+struct mealy;
+
+/// \brief A Cuthill-McKee order of the states: a breadth first search (ignoring the direction of
+/// transitions) from \p start, in which the neighbours of a state are visited in order of
+/// increasing degree. States which transition into each other get nearby numbers. The order is
+/// not reversed (as in RCM), so that \p start remains the first state; the bandwidth is the same.
+/// Returns the states in their new order, only the states connected to \p start are included.
+std::vector<state> cuthill_mckee_order(mealy const & machine, state start);
+
+/// \brief The same machine, in which state new_to_old[s] is called s. The translation of inputs
+/// and outputs is not affected.
+mealy renumber(mealy const & machine, std::vector<state> const & new_to_old);
@@ -3,18 +3,62 @@
 #include "splitting_tree.hpp"
 #include "trie.hpp"
 
+#include <algorithm>
 #include <functional>
 #include <stack>
 #include <utility>
 
 using namespace std;
 
+suffix_id suffix_pool::intern(word_view w) {
+	size_t hash = w.size();
+	for (auto x : w) hash = hash * 31 + x;
+
+	const auto range = index.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it) {
+		const auto v = (*this)[it->second];
+		if (equal(v.begin(), v.end(), w.begin(), w.end())) return it->second;
+	}
+
+	const auto id = suffix_id(size());
+	symbols.insert(symbols.end(), w.begin(), w.end());
+	offsets.push_back(symbols.size());
+	index.emplace(hash, id);
+	return id;
+}
+
 separating_family create_separating_family(const adaptive_distinguishing_sequence & sequence,
                                            const splitting_tree & separating_sequences) {
 	const auto N = sequence.CI.size();
 
 	vector<trie<input>> suffixes(N);
-	separating_family ret(N);
+	separating_family ret;
+	ret.sets.resize(N);
+
+	// For a set of states we need the separators of all nodes in which the set is split. These are
+	// found top-down, by distributing the states over the children (with the index this is cheap).
+	// States which end up alone need no further separators.
+	const splitting_tree_index index(separating_sequences);
+	const function<void(size_t, const vector<state> &)> add_separators
+	    = [&](size_t i, const vector<state> & states) {
+		    const auto & node = *index.nodes[i];
+		    if (states.size() < 2 || node.children.empty()) return;
+
+		    vector<vector<state>> buckets(node.children.size());
+		    for (auto s : states) buckets[index.child_towards(i, s)].push_back(s);
+
+		    const auto non_empty = count_if(begin(buckets), end(buckets),
+		                                    [](const vector<state> & b) { return !b.empty(); });
+		    if (non_empty >= 2) {
+			    for (auto s : states) suffixes[s].insert(node.separator);
+		    }
+
+		    auto c = i + 1;
+		    for (auto const & b : buckets) {
+			    add_separators(c, b);
+			    c = index.end[c];
+		    }
+	    };
 
 	// First we accumulate the kind-of-UIOs and the separating words we need. We will do this with a
 	// breath first search. If we encouter a set of states which is not a singleton, we add
@@ -34,30 +78,20 @@ separating_family create_separating_family(const adaptive_distinguishing_sequenc
 				suffixes[state].insert(uio);
 			}
 
-			vector<bool> states(N, false);
-			for (auto && p : node.CI) {
-				const auto s = p.second;
-				states[s] = true;
-			}
-			const auto roots
-			    = multi_lca(separating_sequences, [&states](state z) -> bool { return states[z]; });
-
-			// NOTE: this is slightly less efficient than doing the same thing inline in lca(...)
-			// but I was to lazy to write a dfs again
-			for (const splitting_tree & n : roots) {
-				for (state s : n.states) {
-					if (states[s]) {
-						suffixes[s].insert(n.separator);
-					}
-				}
-			}
+			vector<state> states;
+			states.reserve(node.CI.size());
+			for (auto && p : node.CI) states.push_back(p.second);
+			add_separators(0, states);
 
 			// Finalize the suffixes
 			for (auto && p : node.CI) {
 				const auto s = p.second;
 				auto & current_suffixes = suffixes[s];
 
-				ret[s].local_suffixes = flatten(current_suffixes);
+				auto & local_suffixes = ret.sets[s].local_suffixes;
+				current_suffixes.for_each([&ret, &local_suffixes](const word & w) {
+					local_suffixes.push_back(ret.suffixes.intern(w));
+				});
 				current_suffixes.clear();
 			}
 
@@ -2,6 +2,10 @@
 
 #include "types.hpp"
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 struct adaptive_distinguishing_sequence;
 struct splitting_tree;
 
@@ -10,15 +14,45 @@ struct splitting_tree;
 /// result. If it is not complete, we augment it with sequences from the HSI-method. In both cases
 /// the result is a separating family (as defined in LY).
 
+using suffix_id = std::uint32_t;
+
+/// \brief Storage for all the suffixes of a family.
+/// Many states share the same suffixes (e.g. the same separators from the splitting tree), so every
+/// distinct word is stored only once. The words are stored contiguously, and are referred to by id.
+struct suffix_pool {
+	/// \brief Adds the word \p w, unless it is already present
+	/// \returns the id of the word
+	suffix_id intern(word_view w);
+
+	word_view operator[](suffix_id i) const {
+		return {symbols.data() + offsets[i], symbols.data() + offsets[i + 1]};
+	}
+
+	size_t size() const { return offsets.size() - 1; }
+
+  private:
+	std::vector<input> symbols;
+	std::vector<size_t> offsets = {0};
+	std::unordered_multimap<size_t, suffix_id> index; // hash -> id
+};
+
 /// \brief A set (belonging to some state) of separating sequences
 /// It only has local_suffixes, as all suffixes are "harmonized", meaning that sequences share
 /// prefixes among the family. With this structure we can define the HSI-method and DS-method. Our
-/// method is a hybrid one. Families are always indexed by state.
+/// method is a hybrid one. The suffixes are given as ids in the pool of the family.
 struct separating_set {
-	std::vector<word> local_suffixes;
+	std::vector<suffix_id> local_suffixes;
 };
 
-using separating_family = std::vector<separating_set>;
+/// \brief The sets of all states, together with the storage of the suffixes.
+/// Families are always indexed by state.
+struct separating_family {
+	suffix_pool suffixes;
+	std::vector<separating_set> sets;
+
+	separating_set const & operator[](state s) const { return sets[s]; }
+	size_t size() const { return sets.size(); }
+};
 
 /// \brief Creates the separating family from the results of the LY algorithm
 /// If the sequence is complete, we do not need the sequences in the splitting tree.
@@ -0,0 +1,356 @@
+#include "server.hpp"
+#include "adaptive_distinguishing_sequence.hpp"
+#include "minimization.hpp"
+#include "reachability.hpp"
+#include "shortest_separators.hpp"
+#include "read_mealy.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <csignal>
+#include <cstring>
+#include <streambuf>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static vector<uint_fast32_t> create_seeds(unsigned long seed) {
+	vector<uint_fast32_t> seeds(4);
+	if (seed != 0) {
+		seed_seq s{seed};
+		s.generate(seeds.begin(), seeds.end());
+	} else {
+		random_device rd;
+		generate(seeds.begin(), seeds.end(), ref(rd));
+	}
+	return seeds;
+}
+
+session::session(const session_options & opts)
+: options(opts), seeds(create_seeds(opts.seed)), hopcroft(0), lee_yannakakis(0) {}
+
+void session::set_options(const session_options & opts) {
+	options = opts;
+	seeds = create_seeds(opts.seed);
+	if (!has_hypothesis()) return;
+
+	build(nullptr);
+	restart();
+}
+
+void session::set_hypothesis(istream & in) {
+	auto machine_and_translation = read_mealy_from_dot(in, false);
+	set_hypothesis(reachable_submachine(move(machine_and_translation.first), 0),
+	               create_reverse_map(machine_and_translation.second.input_indices));
+}
+
+void session::set_hypothesis(mealy new_machine, vector<string> new_inputs) {
+	if (options.minimize) new_machine = minimize(new_machine).machine;
+
+	// We map the states to the previous hypothesis via their access sequences, so that the old
+	// splitting trees can seed the new ones. States which cannot be mapped get state(-1).
+	vector<state> new_to_old;
+	if (has_hypothesis()) {
+		unordered_map<string, input> old_indices;
+		for (input i = 0; i < inputs.size(); ++i) old_indices[inputs[i]] = i;
+
+		const auto access = create_transfer_sequences(canonical_transfer_sequences, new_machine, 0,
+		                                              seeds[2]);
+		new_to_old.assign(new_machine.graph_size, state(-1));
+		word w;
+		for (state s = 0; s < new_machine.graph_size; ++s) {
+			access.materialize(s, w);
+			state t = 0;
+			for (auto i : w) {
+				const auto it = old_indices.find(new_inputs[i]);
+				if (it == old_indices.end()) {
+					t = state(-1);
+					break;
+				}
+				t = apply(machine, t, it->second).to;
+				if (t == state(-1)) break;
+			}
+			new_to_old[s] = t;
+		}
+	}
+
+	machine = move(new_machine);
+	inputs = move(new_inputs);
+	global_inputs.resize(inputs.size());
+	for (input i = 0; i < inputs.size(); ++i) {
+		global_inputs[i] = global_indices.emplace(inputs[i], global_indices.size()).first->second;
+	}
+
+	build(new_to_old.empty() ? nullptr : &new_to_old);
+	restart();
+}
+
+// Constructs all structures for the current machine, seeded by the old splitting trees if possible
+void session::build(const vector<state> * new_to_old) {
+	const auto N = machine.graph_size;
+
+	if (options.no_suffix) {
+		hopcroft = result(0);
+		lee_yannakakis = result(0);
+		family = separating_family{};
+		separating_set s{{family.suffixes.intern(word{})}};
+		family.sets.assign(N, s);
+	} else {
+		const auto create = [&](result const & previous, ::options opt, uint_fast32_t seed) {
+			if (new_to_old && previous.root.states.size() > 0)
+				return create_seeded_splitting_tree(previous, *new_to_old, machine, opt, seed);
+			return create_splitting_tree(machine, opt, seed);
+		};
+
+		// The shortest separators do not depend on a seed tree
+		hopcroft = options.shortest_separators ? create_shortest_splitting_tree(machine)
+		                                       : create(hopcroft, randomized_hopcroft_style, seeds[0]);
+		lee_yannakakis = options.use_distinguishing_sequence
+		                     ? create(lee_yannakakis, randomized_lee_yannakakis_style, seeds[1])
+		                     : result(N);
+
+		const auto sequence = create_adaptive_distinguishing_sequence(lee_yannakakis);
+		family = create_separating_family(sequence, hopcroft.root);
+	}
+
+	prefixes = create_transfer_sequences(options.prefixes, machine, 0, seeds[2]);
+}
+
+void session::restart() {
+	stage = options.fixed_part ? FIRST_PART : options.random_part ? RANDOM_PART : DONE;
+	first_suite.clear();
+	position = 0;
+	second_mid_sequences.assign(1, word{});
+	for (size_t k = 0; k <= options.l; ++k) {
+		second_mid_sequences = all_seqs(0, machine.input_size, second_mid_sequences);
+	}
+	cursor = test_cursor{};
+	generator.seed(seeds[3]);
+	next_random = 0;
+}
+
+size_t session::next_tests(size_t n, ostream & out) {
+	// The tests are collected first, as the reply starts with their number
+	stringstream tests;
+	const auto written = next_tests(n, [&](word const & w) {
+		for (auto && x : w) tests << inputs[x] << ' ';
+		tests << '\n';
+	});
+
+	out << "tests " << written << '\n' << tests.str();
+	return written;
+}
+
+size_t session::next_tests(size_t n, const function<void(word const &)> & f) {
+	if (!has_hypothesis()) throw runtime_error("There is no hypothesis yet");
+
+	size_t written = 0;
+	word global;
+	const auto emit = [&](word const & w) {
+		global.resize(w.size());
+		for (size_t i = 0; i < w.size(); ++i) global[i] = global_inputs[w[i]];
+		if (options.skip_dup && !given.insert(global)) return true;
+
+		f(w);
+		return ++written < n;
+	};
+
+	// Stops the enumeration when n tests are written
+	bool stopped = n == 0;
+	word buffer;
+	const writer output{
+	    [&buffer](word_view w) { buffer.insert(buffer.end(), w.begin(), w.end()); },
+	    [&]() {
+		    const auto more = emit(buffer);
+		    buffer.clear();
+		    stopped = !more;
+		    return more;
+		}};
+
+	if (!stopped && stage == FIRST_PART) {
+		if (first_suite.empty() && position == 0) {
+			trie<input> first;
+			vector<word> mid_sequences(1);
+			test(machine, prefixes, mid_sequences, family, options.l + 1,
+			     {[&buffer](word_view w) { buffer.insert(buffer.end(), w.begin(), w.end()); },
+			      [&buffer, &first]() {
+				      first.insert(buffer);
+				      buffer.clear();
+				      return true;
+				  }});
+			first_suite = flatten(first);
+			mt19937 g;
+			shuffle(first_suite.begin(), first_suite.end(), g);
+		}
+
+		while (!stopped && position < first_suite.size()) {
+			stopped = !emit(first_suite[position++]);
+		}
+
+		if (position == first_suite.size()) {
+			first_suite.clear();
+			stage = SECOND_PART;
+		}
+	}
+
+	if (!stopped && stage == SECOND_PART) {
+		// test() extends the middle sequences, so we give it a copy
+		auto mid_sequences = second_mid_sequences;
+		test(machine, prefixes, mid_sequences, family, options.k_max - options.l, output, shard{},
+		     cursor);
+		if (!stopped) stage = options.random_part ? RANDOM_PART : DONE;
+	}
+
+	if (!stopped && stage == RANDOM_PART) {
+		const auto min_k = options.fixed_part ? options.k_max + 1 : 0;
+		if (options.philox) {
+			randomized_test(machine, prefixes, family, min_k, options.rnd_length, output, seeds[3],
+			                next_random);
+		} else {
+			randomized_test(machine, prefixes, family, min_k, options.rnd_length, output,
+			                generator);
+		}
+	}
+
+	return written;
+}
+
+bool serve(istream & in, ostream & out, session & s,
+           const function<session_options(string const &)> & parse_options) {
+	string line;
+	while (getline(in, line)) {
+		stringstream ss(line);
+		string request;
+		if (!(ss >> request)) continue;
+
+		try {
+			if (request == "hypothesis") {
+				size_t bytes = 0;
+				if (!(ss >> bytes)) throw runtime_error("The size of the hypothesis is missing");
+				string dot(bytes, '\0');
+				if (!in.read(&dot[0], bytes)) throw runtime_error("The hypothesis is incomplete");
+
+				stringstream dot_stream(dot);
+				s.set_hypothesis(dot_stream);
+				out << "ok " << s.hypothesis().graph_size << " states\n";
+			} else if (request == "options") {
+				string rest;
+				getline(ss, rest);
+				s.set_options(parse_options(rest));
+				out << "ok\n";
+			} else if (request == "next") {
+				size_t n = 0;
+				if (!(ss >> n)) throw runtime_error("The number of tests is missing");
+				s.next_tests(n, out);
+			} else if (request == "forget") {
+				s.forget();
+				out << "ok\n";
+			} else if (request == "stop") {
+				out << "bye" << endl;
+				return false;
+			} else {
+				throw runtime_error("Unknown request " + request);
+			}
+		} catch (exception const & e) {
+			out << "error " << e.what() << '\n';
+		}
+		out << flush;
+	}
+	return true;
+}
+
+#ifndef _WIN32
+namespace {
+// A minimal stream buffer on a file descriptor (e.g. a socket), for reading and writing
+struct fd_buffer : streambuf {
+	explicit fd_buffer(int fd) : fd(fd) {
+		setg(in, in, in);
+		setp(out, out + sizeof(out));
+	}
+	~fd_buffer() override { sync(); }
+
+  protected:
+	int_type underflow() override {
+		const auto n = ::read(fd, in, sizeof(in));
+		if (n <= 0) return traits_type::eof();
+		setg(in, in, in + n);
+		return traits_type::to_int_type(*gptr());
+	}
+
+	int_type overflow(int_type c) override {
+		if (sync() == -1) return traits_type::eof();
+		if (!traits_type::eq_int_type(c, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+		return traits_type::not_eof(c);
+	}
+
+	int sync() override {
+		auto p = pbase();
+		while (p < pptr()) {
+			const auto n = ::write(fd, p, size_t(pptr() - p));
+			if (n <= 0) return -1;
+			p += n;
+		}
+		setp(out, out + sizeof(out));
+		return 0;
+	}
+
+  private:
+	int fd;
+	char in[1 << 16];
+	char out[1 << 16];
+};
+}
+
+void serve_unix_socket(const string & path, session & s,
+                       const function<session_options(string const &)> & parse_options) {
+	// A client which goes away should not kill the server
+	signal(SIGPIPE, SIG_IGN);
+
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path)) throw runtime_error("Socket path is too long");
+	strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+	const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) throw runtime_error("Could not create a socket");
+	unlink(path.c_str());
+	if (bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0
+	    || listen(listener, 1) < 0) {
+		close(listener);
+		throw runtime_error("Could not listen on " + path);
+	}
+
+	bool running = true;
+	while (running) {
+		const int connection = accept(listener, nullptr, nullptr);
+		if (connection < 0) continue;
+
+		{
+			fd_buffer buffer(connection);
+			iostream stream(&buffer);
+			running = serve(stream, stream, s, parse_options);
+		}
+		close(connection);
+	}
+
+	close(listener);
+	unlink(path.c_str());
+}
+#else
+void serve_unix_socket(const string &, session &,
+                       const function<session_options(string const &)> &) {
+	throw runtime_error("Unix domain sockets are not supported on this platform");
+}
+#endif
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "mealy.hpp"
+#include "separating_family.hpp"
+#include "splitting_tree.hpp"
+#include "test_suite.hpp"
+#include "transfer_sequences.hpp"
+#include "trie.hpp"
+#include "types.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// \brief The options which determine the test suite of a session (see main for their meaning)
+struct session_options {
+	bool fixed_part = true;
+	bool random_part = true;
+	bool no_suffix = false;
+	bool use_distinguishing_sequence = true;
+	transfer_options prefixes = minimal_transfer_sequences;
+	size_t k_max = 3;
+	size_t l = 2;
+	size_t rnd_length = 8;
+	unsigned long seed = 0; // 0 for unset/noise
+	bool skip_dup = true;
+	bool philox = false;
+	bool minimize = false;
+	bool shortest_separators = false;
+};
+
+///
+/// \brief Generates test suites for successive hypotheses (e.g. of a learning algorithm). All
+/// structures are built anew for every hypothesis, but the splitting trees are seeded with those
+/// of the previous hypothesis (see create_seeded_splitting_tree), which keeps the separators
+/// stable. Tests which were already given out (for any hypothesis) are not given again. Tests are
+/// generated on demand, in chunks.
+///
+struct session {
+	explicit session(session_options const & opts);
+
+	/// \brief Replaces the options, this restarts the test suite of the current hypothesis
+	void set_options(session_options const & opts);
+
+	/// \brief Reads a new hypothesis (as dot) from \p in, and restarts its test suite
+	void set_hypothesis(std::istream & in);
+
+	/// \brief Replaces the hypothesis by \p m (possibly partial, with all states reachable from state
+	/// 0). The inputs are identified by \p input_names over different hypotheses. With the minimize
+	/// option, the states of hypothesis() are the classes of equivalent states of \p m.
+	void set_hypothesis(mealy m, std::vector<std::string> input_names);
+
+	/// \brief Writes at most \p n new tests (one per line) to \p out, fewer only if the test suite
+	/// is finished. Returns the number of tests written.
+	size_t next_tests(size_t n, std::ostream & out);
+
+	/// \brief Same as above, but gives the tests to \p f
+	size_t next_tests(size_t n, std::function<void(word const &)> const & f);
+
+	/// \brief Forgets which tests were given out, so that they may be given again
+	void forget() { given.clear(); }
+
+	bool has_hypothesis() const { return !inputs.empty(); }
+	mealy const & hypothesis() const { return machine; }
+	transfer_sequences const & transfer() const { return prefixes; }
+	separating_family const & separating() const { return family; }
+
+  private:
+	void build(std::vector<state> const * new_to_old);
+	void restart();
+
+	session_options options;
+	std::vector<uint_fast32_t> seeds;
+
+	// The current hypothesis, and its structures
+	mealy machine;
+	std::vector<std::string> inputs;
+	std::vector<input> global_inputs; // the inputs of machine as indices in global_indices
+	result hopcroft;
+	result lee_yannakakis;
+	transfer_sequences prefixes;
+	separating_family family;
+
+	// Where we are in the test suite of the current hypothesis
+	enum stage_t { FIRST_PART, SECOND_PART, RANDOM_PART, DONE };
+	stage_t stage = FIRST_PART;
+	std::vector<word> first_suite;
+	size_t position = 0;
+	std::vector<word> second_mid_sequences;
+	test_cursor cursor;
+	std::mt19937 generator;
+	size_t next_random = 0;
+
+	// The tests given out so far, in global indices (the inputs of hypotheses may be numbered
+	// differently)
+	std::unordered_map<std::string, input> global_indices;
+	trie<input> given;
+};
+
+/// \brief Handles requests from \p in, and writes the replies to \p out. Every request is a line,
+/// a hypothesis is followed by its dot text. The requests are
+///   hypothesis <number of bytes>   a new hypothesis, given by the bytes after this line
+///   options <command line options> new options, which are parsed by \p parse_options
+///   next <n>                       asks for n new tests
+///   forget                         forgets which tests were given out
+///   stop                           stops the server
+/// The replies are "ok ...", "error <message>", "tests <m>" followed by m tests, and "bye".
+/// Returns false if stop was requested, true if \p in has ended.
+bool serve(std::istream & in, std::ostream & out, session & s,
+           std::function<session_options(std::string const &)> const & parse_options);
+
+/// \brief Serves the connections to a Unix domain socket at \p path, one after another, until a
+/// stop request.
+void serve_unix_socket(std::string const & path, session & s,
+                       std::function<session_options(std::string const &)> const & parse_options);
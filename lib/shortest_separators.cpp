@@ -0,0 +1,172 @@
+#include "shortest_separators.hpp"
+#include "mealy.hpp"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+result create_shortest_splitting_tree(const mealy & m) {
+	const auto N = m.graph_size;
+	const auto P = m.input_size;
+	// An undefined transition (in a partial machine) is observed as an extra output
+	const auto undefined = size_t(m.output_size);
+
+	// We build the tree in a flat array, and convert it at the end
+	struct node {
+		size_t parent;
+		size_t depth;
+		word separator;
+		vector<size_t> children;
+		vector<state> states; // only for leaves
+	};
+	vector<node> nodes;
+	nodes.push_back({size_t(-1), 0, {}, {}, {}});
+	nodes[0].states.resize(N);
+	for (state s = 0; s < N; ++s) nodes[0].states[s] = s;
+
+	vector<size_t> leaf_of(N, 0);
+	vector<size_t> previous_leaf; // the leaves at the start of the current level
+
+	// Marks on nodes, with stamps so that we do not need to clear them
+	vector<size_t> node_stamp;
+	size_t stamp = 0;
+
+	// The lowest common ancestor of some nodes, by climbing from the deepest ones
+	const auto lca = [&](vector<size_t> const & xs) {
+		auto ret = xs.front();
+		for (auto x : xs) {
+			while (nodes[x].depth > nodes[ret].depth) x = nodes[x].parent;
+			while (nodes[ret].depth > nodes[x].depth) ret = nodes[ret].parent;
+			while (x != ret) {
+				x = nodes[x].parent;
+				ret = nodes[ret].parent;
+			}
+		}
+		return ret;
+	};
+
+	// Splits leaf x by the observed output of w, returns false if all outputs are equal
+	vector<size_t> group_of_output(m.output_size + 1, size_t(-1));
+	vector<vector<state>> groups;
+	const auto split = [&](size_t x, word const & w) {
+		groups.clear();
+		for (auto s : nodes[x].states) {
+			const auto r = try_apply(m, s, w.begin(), w.end());
+			const auto o = r.to == state(-1) ? undefined : size_t(r.out);
+			auto & g = group_of_output[o];
+			if (g == size_t(-1)) {
+				g = groups.size();
+				groups.emplace_back();
+			}
+			groups[g].push_back(s);
+		}
+		for (auto s : nodes[x].states) {
+			const auto r = try_apply(m, s, w.begin(), w.end());
+			group_of_output[r.to == state(-1) ? undefined : size_t(r.out)] = size_t(-1);
+		}
+		if (groups.size() < 2) return false;
+
+		nodes[x].separator = w;
+		nodes[x].states.clear();
+		nodes[x].states.shrink_to_fit();
+		for (auto & g : groups) {
+			const auto child = nodes.size();
+			nodes.push_back({x, nodes[x].depth + 1, {}, {}, move(g)});
+			nodes[x].children.push_back(child);
+			for (auto s : nodes[child].states) leaf_of[s] = child;
+		}
+		return true;
+	};
+
+	const auto predecessors = create_predecessor_index(m);
+	vector<size_t> candidates{0};
+	vector<pair<size_t, input>> work;
+	vector<size_t> successor_leaves;
+	word w;
+
+	for (size_t level = 1; !candidates.empty(); ++level) {
+		previous_leaf = leaf_of;
+		const auto first_new_node = nodes.size();
+
+		for (auto c : candidates) {
+			work.assign(1, {c, 0});
+			while (!work.empty()) {
+				const auto x = work.back().first;
+				auto a = work.back().second;
+				work.pop_back();
+				if (nodes[x].states.size() < 2) continue;
+
+				// An input which does not split a block, does not split a part of it either. But an
+				// input which did split it, may split the parts further (with a deeper lca).
+				for (; a < P; ++a) {
+					const auto first = nodes[x].states.front();
+					if (level == 1) {
+						w.assign(1, a);
+					} else {
+						// Equal outputs, so a is defined in all states or in none
+						if (apply(m, first, a).to == state(-1)) continue;
+
+						stamp++;
+						successor_leaves.clear();
+						node_stamp.resize(nodes.size(), 0);
+						for (auto s : nodes[x].states) {
+							const auto l = previous_leaf[apply(m, s, a).to];
+							if (node_stamp[l] == stamp) continue;
+							node_stamp[l] = stamp;
+							successor_leaves.push_back(l);
+						}
+						if (successor_leaves.size() < 2) continue;
+
+						w.assign(1, a);
+						const auto & separator = nodes[lca(successor_leaves)].separator;
+						w.insert(w.end(), separator.begin(), separator.end());
+					}
+
+					if (!split(x, w)) continue;
+					for (auto child : nodes[x].children) work.emplace_back(child, a);
+					break;
+				}
+			}
+		}
+
+		// The blocks which may split on the next level: those with a successor in a new block
+		stamp++;
+		candidates.clear();
+		node_stamp.resize(nodes.size(), 0);
+		for (auto x = first_new_node; x < nodes.size(); ++x) {
+			if (!nodes[x].children.empty()) continue;
+			for (auto t : nodes[x].states) {
+				for (size_t j = 0; j < predecessors.size(t); ++j) {
+					const auto l = leaf_of[predecessors(t, j).second];
+					if (nodes[l].states.size() < 2 || node_stamp[l] == stamp) continue;
+					node_stamp[l] = stamp;
+					candidates.push_back(l);
+				}
+			}
+		}
+	}
+
+	// Convert to the recursive representation
+	result ret(N);
+	ret.is_complete = true;
+	const function<void(size_t, splitting_tree &)> convert = [&](size_t x, splitting_tree & out) {
+		out.depth = nodes[x].depth;
+		out.separator = nodes[x].separator;
+		if (nodes[x].children.empty()) {
+			out.states = nodes[x].states;
+			if (out.states.size() > 1) ret.is_complete = false;
+			return;
+		}
+		out.states.clear();
+		out.children.assign(nodes[x].children.size(), splitting_tree(0, out.depth + 1));
+		for (size_t i = 0; i < out.children.size(); ++i) {
+			convert(nodes[x].children[i], out.children[i]);
+			const auto & cs = out.children[i].states;
+			out.states.insert(out.states.end(), cs.begin(), cs.end());
+		}
+	};
+	convert(0, ret.root);
+	return ret;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "splitting_tree.hpp"
+
+struct mealy;
+
+///
+/// \brief Creates a splitting tree in which every pair of states is separated by a shortest
+/// separating sequence, for all pairs at once. This can be used instead of the (randomized)
+/// Hopcroft tree for create_separating_family, the suffixes then are as short as possible.
+///
+/// The length of a shortest separator of s and t is the first level of Moore's refinement
+/// (P_k: states are equivalent on words of length <= k) in which s and t are apart. We refine
+/// level by level, as a backward breadth first search over pairs would, but we only store the
+/// partitions. This takes O(N) memory instead of O(N^2) for the pairs. Within a level, a block is
+/// split on one input at a time (a node has a single separator): by the output of that input on
+/// the first level, and by the input followed by the separator of the lca of the successors on
+/// later levels. Only blocks with a successor in a block which was split on the previous level
+/// are looked at.
+///
+/// The successor cache is not filled, so the result cannot be used for an adaptive distinguishing
+/// sequence.
+///
+result create_shortest_splitting_tree(mealy const & m);
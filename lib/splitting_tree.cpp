@@ -15,12 +15,100 @@ splitting_tree::splitting_tree(size_t N, size_t d) : states(N), depth(d) {
 	iota(begin(states), end(states), 0);
 }
 
-result create_splitting_tree(const mealy & g, options opt, uint_fast32_t random_seed) {
+splitting_tree_index::splitting_tree_index(const splitting_tree & root) : leaf(root.states.size()) {
+	// An explicit stack, as trees may be as deep as the number of states
+	vector<pair<const splitting_tree *, size_t>> stack{{&root, size_t(-1)}};
+	vector<size_t> open;
+	while (!stack.empty()) {
+		const auto node = stack.back().first;
+		const auto p = stack.back().second;
+		stack.pop_back();
+
+		// Close the nodes which are not an ancestor of this one
+		while (!open.empty() && open.back() != p) {
+			end[open.back()] = nodes.size();
+			open.pop_back();
+		}
+
+		const auto i = nodes.size();
+		nodes.push_back(node);
+		parent.push_back(p);
+		end.push_back(0);
+		open.push_back(i);
+
+		if (node->children.empty()) {
+			for (auto s : node->states) leaf[s] = i;
+		}
+		for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+			stack.emplace_back(&*it, i);
+		}
+	}
+	for (auto i : open) end[i] = nodes.size();
+}
+
+using work_queue = queue<reference_wrapper<splitting_tree>>;
+
+static void add_new_blocks(list<list<state>> const & new_blocks, splitting_tree & boom) {
+	boom.children.assign(new_blocks.size(), splitting_tree(0, boom.depth + 1));
+
+	size_t i = 0;
+	for (auto && b : new_blocks) {
+		boom.children[i++].states.assign(begin(b), end(b));
+	}
+
+	assert(boom.states.size() == accumulate(begin(boom.children), end(boom.children), 0ul,
+	                                        [](size_t l, const splitting_tree & r) {
+		                                        return l + r.states.size();
+		                                    }));
+}
+
+// Checks whether the word [b, e) is injective on every block
+template <typename Iterator>
+static bool is_valid(const mealy & g, list<list<state>> const & blocks, Iterator b, Iterator e) {
+	for (auto && block : blocks) {
+		// Undefined successors are merged as well (into the sink we do not have)
+		const auto new_blocks = partition_(begin(block), end(block), [b, e, &g](state state) {
+			const auto t = try_apply(g, state, b, e).to;
+			return t == ::state(-1) ? g.graph_size : t;
+		}, g.graph_size + 1);
+		for (auto && new_block : new_blocks) {
+			if (new_block.size() != 1) return false;
+		}
+	}
+	return true;
+}
+
+// In a partial machine, an undefined transition is observed as an extra output (output_size), and
+// the word stops there. States only stay together when their outputs are equal, so a separator is
+// defined in all states of its node, except that its last symbol may be undefined in some.
+template <typename Iterator>
+static mealy::edge apply_observed(const mealy & g, state s, Iterator b, Iterator e) {
+	auto r = try_apply(g, s, b, e);
+	if (r.to == state(-1)) r.out = output(g.output_size);
+	return r;
+}
+
+static bool defined_on_all(const mealy & g, const vector<state> & states, input symbol) {
+	for (auto s : states) {
+		if (apply(g, s, symbol).to == state(-1)) return false;
+	}
+	return true;
+}
+
+static void update_succession(vector<vector<state>> & succession, size_t N, state s, state t,
+                              size_t depth) {
+	if (succession.size() < depth + 1) succession.resize(depth + 1, vector<state>(N, state(-1)));
+	succession[depth][s] = t;
+}
+
+// The partition refinement itself. Refines all the leaves in work (and their children) until
+// everything is split, or until no progress can be made.
+static void refine(const mealy & g, options opt, mt19937 & generator, result & ret,
+                   work_queue & work) {
 	const auto N = g.graph_size;
 	const auto P = g.input_size;
-	const auto Q = g.output_size;
+	const auto Q = g.output_size + 1; // including the undefined output
 
-	result ret(N);
 	auto & root = ret.root;
 	auto & succession = ret.successor_cache;
 
@@ -28,54 +116,26 @@ result create_splitting_tree(const mealy & g, options opt, uint_fast32_t random_
 	// In some cases we cannot split, and have to wait for other parts of the
 	// tree. We keep track of how many times we did no work. If this is too
 	// much, there is no complete splitting tree.
-	queue<reference_wrapper<splitting_tree>> work;
 	size_t days_without_progress = 0;
 
 	// List of inputs, will be shuffled in case of randomizations
 	vector<input> all_inputs(P);
 	iota(begin(all_inputs), end(all_inputs), 0);
-	mt19937 generator(random_seed);
 
 	size_t current_order = 0;
 	bool split_in_current_order = false;
 
 	// Some lambda functions capturing some state, makes the code a bit easier :)
 	const auto add_push_new_block = [&work](list<list<state>> const & new_blocks, splitting_tree& boom) {
-		boom.children.assign(new_blocks.size(), splitting_tree(0, boom.depth + 1));
-
-		size_t i = 0;
-		for (auto && b : new_blocks) {
-			boom.children[i++].states.assign(begin(b), end(b));
-		}
-
+		add_new_blocks(new_blocks, boom);
 		for (auto && c : boom.children) {
 			work.push(c);
 		}
-
-		assert(boom.states.size() == accumulate(begin(boom.children), end(boom.children), 0ul,
-		                                        [](size_t l, const splitting_tree & r) {
-		                                        	return l + r.states.size();
-		                                        }));
-	};
-	const auto is_valid = [N, opt, &g](list<list<state>> const & blocks, input symbol) {
-		for (auto && block : blocks) {
-			const auto new_blocks = partition_(begin(block), end(block), [symbol, &g](state state) {
-				return apply(g, state, symbol).to;
-			}, N);
-			for (auto && new_block : new_blocks) {
-				if (new_block.size() != 1) return false;
-			}
-		}
-		return true;
 	};
-	const auto update_succession = [N, &succession](state s, state t, size_t depth) {
-		if (succession.size() < depth + 1)
-			succession.resize(depth + 1, vector<state>(N, state(-1)));
-		succession[depth][s] = t;
+	const auto update_succession_ = [N, &succession](state s, state t, size_t depth) {
+		update_succession(succession, N, s, t, depth);
 	};
 
-	// We'll start with the root, obviously
-	work.push(root);
 	while (!work.empty()) {
 		splitting_tree & boom = work.front();
 		work.pop();
@@ -90,9 +150,9 @@ result create_splitting_tree(const mealy & g, options opt, uint_fast32_t random_
 			for (input symbol : all_inputs) {
 				const auto new_blocks = partition_(
 				    begin(boom.states),
-				    end(boom.states), [symbol, depth, &g, &update_succession](state state) {
-				    	const auto r = apply(g, state, symbol);
-				    	update_succession(state, r.to, depth);
+				    end(boom.states), [symbol, depth, &g, &update_succession_](state state) {
+				    	const auto r = apply_observed(g, state, &symbol, &symbol + 1);
+				    	update_succession_(state, r.to, depth);
 				    	return r.out;
 				    }, Q);
 
@@ -100,7 +160,7 @@ result create_splitting_tree(const mealy & g, options opt, uint_fast32_t random_
 				if (new_blocks.size() == 1) continue;
 
 				// not a valid split -> continue
-				if (opt.check_validity && !is_valid(new_blocks, symbol)) continue;
+				if (opt.check_validity && !is_valid(g, new_blocks, &symbol, &symbol + 1)) continue;
 
 				// a succesful split, update partition and add the children
 				boom.separator = {symbol};
@@ -111,8 +171,10 @@ result create_splitting_tree(const mealy & g, options opt, uint_fast32_t random_
 		}
 
 		if (!opt.assert_minimal_order || current_order > 0) {
-			// Then try to split on state
+			// Then try to split on state (outputs are equal, so symbol is defined on all or none)
 			for (input symbol : all_inputs) {
+				if (!defined_on_all(g, boom.states, symbol)) continue;
+
 				vector<bool> successor_states(N, false);
 				for (auto && state : boom.states) {
 					successor_states[apply(g, state, symbol).to] = true;
@@ -132,14 +194,14 @@ result create_splitting_tree(const mealy & g, options opt, uint_fast32_t random_
 				const vector<input> word = concat(vector<input>(1, symbol), oboom.separator);
 				const auto new_blocks = partition_(
 				    begin(boom.states),
-				    end(boom.states), [word, depth, &g, &update_succession](state state) {
-				    	const mealy::edge r = apply(g, state, word.begin(), word.end());
-				    	update_succession(state, r.to, depth);
+				    end(boom.states), [word, depth, &g, &update_succession_](state state) {
+				    	const mealy::edge r = apply_observed(g, state, word.begin(), word.end());
+				    	update_succession_(state, r.to, depth);
 				    	return r.out;
 				    }, Q);
 
 				// not a valid split -> continue
-				if (opt.check_validity && !is_valid(new_blocks, symbol)) continue;
+				if (opt.check_validity && !is_valid(g, new_blocks, &symbol, &symbol + 1)) continue;
 
 				assert(new_blocks.size() > 1);
 
@@ -155,7 +217,7 @@ result create_splitting_tree(const mealy & g, options opt, uint_fast32_t random_
 		if (days_without_progress++ >= work.size()) {
 			if (!split_in_current_order || !opt.assert_minimal_order) {
 				ret.is_complete = false;
-				return ret;
+				return;
 			}
 
 			current_order++;
@@ -169,6 +231,103 @@ result create_splitting_tree(const mealy & g, options opt, uint_fast32_t random_
 		split_in_current_order = true;
 		days_without_progress = 0;
 	}
+}
+
+result create_splitting_tree(const mealy & g, options opt, uint_fast32_t random_seed) {
+	result ret(g.graph_size);
+	mt19937 generator(random_seed);
+
+	// We'll start with the root, obviously
+	work_queue work;
+	work.push(ret.root);
+	refine(g, opt, generator, ret, work);
+
+	return ret;
+}
+
+// Copies the splits of the old tree to the new tree, as long as they are still valid. The states of
+// the new machine are guided through the old tree by their image under new_to_old. Leaves for which
+// this is not possible are put on the work queue, to be refined in the usual way.
+static void replay(const mealy & g, options opt, size_t old_node,
+                   const splitting_tree_index & old_index, const vector<state> & new_to_old,
+                   vector<bool> & on_track, splitting_tree & boom, result & ret, work_queue & work) {
+	if (boom.states.size() == 1) return;
+
+	const auto & old = *old_index.nodes[old_node];
+	const auto & w = old.separator;
+	if (old.children.empty() || w.empty()) {
+		work.push(boom);
+		return;
+	}
+
+	// The separator should still be defined and produce equal outputs, except for the last symbol
+	const auto N = g.graph_size;
+	const auto first = boom.states.front();
+	for (auto s : boom.states) {
+		state t1 = first;
+		state t2 = s;
+		for (size_t i = 0; i + 1 < w.size(); ++i) {
+			const auto r1 = apply(g, t1, w[i]);
+			const auto r2 = apply(g, t2, w[i]);
+			if (r1.to == state(-1) || r2.to == state(-1) || r1.out != r2.out) {
+				work.push(boom);
+				return;
+			}
+			t1 = r1.to;
+			t2 = r2.to;
+		}
+	}
+
+	const size_t depth = boom.depth;
+	const auto new_blocks = partition_(begin(boom.states), end(boom.states), [&](state s) {
+		const auto r = apply_observed(g, s, w.begin(), w.end());
+		update_succession(ret.successor_cache, N, s, r.to, depth);
+		return r.out;
+	}, g.output_size + 1);
+
+	if (new_blocks.size() == 1 || (opt.check_validity && !is_valid(g, new_blocks, w.begin(), w.end()))) {
+		work.push(boom);
+		return;
+	}
+
+	boom.separator = w;
+	add_new_blocks(new_blocks, boom);
+
+	for (auto & c : boom.children) {
+		// Find the old child in which the (still relevant) old states ended up
+		size_t old_child = size_t(-1);
+		for (auto s : c.states) {
+			if (!on_track[s]) continue;
+			const auto i = old_index.child_towards(old_node, new_to_old[s]);
+			if (old_child == size_t(-1)) old_child = i;
+			if (i != old_child) on_track[s] = false;
+		}
+
+		if (old_child == size_t(-1)) {
+			if (c.states.size() > 1) work.push(c);
+			continue;
+		}
+
+		replay(g, opt, old_index.child(old_node, old_child), old_index, new_to_old, on_track, c, ret, work);
+	}
+}
+
+result create_seeded_splitting_tree(const result & seed, const vector<state> & new_to_old,
+                                    const mealy & g, options opt, uint_fast32_t random_seed) {
+	result ret(g.graph_size);
+	mt19937 generator(random_seed);
+
+	const auto & old_root = seed.root;
+	const splitting_tree_index old_index(old_root);
+
+	vector<bool> on_track(g.graph_size, false);
+	for (state s = 0; s < g.graph_size; ++s) {
+		on_track[s] = s < new_to_old.size() && new_to_old[s] < old_root.states.size();
+	}
+
+	work_queue work;
+	replay(g, opt, 0, old_index, new_to_old, on_track, ret.root, ret, work);
+	refine(g, opt, generator, ret, work);
 
 	return ret;
 }
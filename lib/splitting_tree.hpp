@@ -2,6 +2,10 @@
 
 #include "mealy.hpp"
 
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
 /// \brief A splitting tree as defined in Lee & Yannakakis.
 /// This is also known as a derivation tree (Knuutila). Both the Gill/Moore/Hopcroft-style and the
 /// Lee&Yannakakis-style trees are splitting trees.
@@ -14,6 +18,39 @@ struct splitting_tree {
 	size_t depth = 0;
 };
 
+/// \brief Numbers the nodes of a tree in pre-order, and maps every state to its leaf.
+/// The nodes below node i are i + 1, ..., end[i] - 1, so ancestors are found by comparing numbers.
+/// This takes O(N) memory, also for deep trees (storing a path per state would take O(N^2)).
+struct splitting_tree_index {
+	splitting_tree_index(splitting_tree const & root);
+
+	/// \brief The index of the child of node \p i in which state \p s lies (i should contain s)
+	size_t child_towards(size_t i, state s) const {
+		size_t index = 0;
+		for (auto c = i + 1; end[c] <= leaf[s]; c = end[c]) ++index;
+		return index;
+	}
+
+	/// \brief The node number of child \p index of node \p i
+	size_t child(size_t i, size_t index) const {
+		auto c = i + 1;
+		while (index--) c = end[c];
+		return c;
+	}
+
+	/// \brief The deepest node containing both nodes \p a and \p b
+	size_t lca(size_t a, size_t b) const {
+		if (a > b) std::swap(a, b);
+		while (end[a] <= b) a = parent[a];
+		return a;
+	}
+
+	std::vector<splitting_tree const *> nodes;
+	std::vector<size_t> parent; // size_t(-1) for the root
+	std::vector<size_t> end;
+	std::vector<size_t> leaf; // state -> node
+};
+
 /// \brief the generic lca implementation.
 /// It uses \p store to store the relevant nodes (in some bottom up order), the last store is the
 /// actual lowest common ancestor (but the other might be relevant as well). The function \p f is
@@ -112,3 +149,14 @@ struct result {
 /// \brief Creates a splitting tree by partition refinement.
 /// \returns a splitting tree and other calculated structures.
 result create_splitting_tree(mealy const & m, options opt, uint_fast32_t random_seed);
+
+/// \brief Seeded splitting-tree construction: creates a splitting tree for \p m, trying the splits
+/// of the \p seed result first. Meant for active learning, where a hypothesis mostly refines the
+/// previous one. The map \p new_to_old gives for each state of \p m the corresponding state of the
+/// seed (or state(-1) if there is none). Separators of the seed which are still valid for \p m are
+/// kept, and only the leaves where this fails are refined by searching for new splits. This keeps
+/// the separators (and so the tests) stable over hypotheses. It is a complete construction, not
+/// an incremental update: the cost is at least linear in the size of \p m. Note that
+/// \p assert_minimal_order cannot be guaranteed for copied splits.
+result create_seeded_splitting_tree(result const & seed, std::vector<state> const & new_to_old,
+                                    mealy const & m, options opt, uint_fast32_t random_seed);
@@ -0,0 +1,46 @@
+#include "suite_formats.hpp"
+
+#include <algorithm>
+#include <ostream>
+
+using namespace std;
+
+void write_tree(const trie<input> & t, const vector<string> & inputs, ostream & os) {
+	t.for_each_branch(
+	    [&](word const & w) {
+		    for (auto && x : w) os << inputs[x] << ' ';
+		    os << '\n';
+		},
+	    [&os] { os << "[\n"; }, [&os] { os << "]\n"; });
+	os << flush;
+}
+
+front_coder::front_coder(const vector<string> & inputs, bool use_ids)
+: inputs(inputs), use_ids(use_ids) {}
+
+void front_coder::write_header(ostream & os) {
+	previous.clear();
+	if (!use_ids) {
+		os << "front\n";
+		return;
+	}
+
+	os << "front-id " << inputs.size();
+	for (auto && name : inputs) os << ' ' << name;
+	os << '\n';
+}
+
+void front_coder::write(word_view w, ostream & os) {
+	const auto n = min(w.size(), previous.size());
+	const auto shared = size_t(mismatch(w.begin(), w.begin() + n, previous.begin()).first - w.begin());
+	os << shared;
+	for (size_t i = shared; i < w.size(); ++i) {
+		if (use_ids) {
+			os << ' ' << w[i];
+		} else {
+			os << ' ' << inputs[w[i]];
+		}
+	}
+
+	previous.assign(w.begin(), w.end());
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "trie.hpp"
+#include "types.hpp"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// \brief Writes the tests in \p t as a tree, such that every shared prefix occurs once. Each line
+/// is either a run of symbols (to be applied), "[" to take a snapshot of the system, or "]" to
+/// restore the last snapshot (and forget it). A test ends at every "]" and at the end, so the
+/// tests are exactly the words of the trie. Runs are compressed as in a radix tree.
+void write_tree(trie<input> const & t, std::vector<std::string> const & inputs, std::ostream & os);
+
+/// \brief Writes tests front coded: a test is written as the length of the prefix it shares with
+/// the previous test, followed by the remaining symbols. Consecutive tests often share their
+/// prefix, so this is much smaller. Symbols are written by name, or (with \p use_ids) as their
+/// index in a symbol table, which is given in the header. The program decode_suite reads this.
+struct front_coder {
+	front_coder(std::vector<std::string> const & inputs, bool use_ids);
+
+	/// \brief Writes the header line, and forgets the previous test (so that the output can be
+	/// appended to another front coded stream)
+	void write_header(std::ostream & os);
+
+	/// \brief Writes the test \p w (without newline)
+	void write(word_view w, std::ostream & os);
+
+  private:
+	std::vector<std::string> const & inputs;
+	bool use_ids;
+	word previous;
+};
@@ -0,0 +1,161 @@
+#include "suite_size.hpp"
+#include "mealy.hpp"
+#include "separating_family.hpp"
+#include "transfer_sequences.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace std;
+
+vector<suite_size> count_tests(const mealy & specification, const transfer_sequences & prefixes,
+                               const separating_family & separating_family, size_t k_max) {
+	const auto N = specification.graph_size;
+
+	// Number of suffixes, and their total length, per state
+	vector<double> suffixes(N, 0);
+	vector<double> suffix_symbols(N, 0);
+	for (state s = 0; s < N; ++s) {
+		for (auto id : separating_family[s].local_suffixes) {
+			suffixes[s] += 1;
+			suffix_symbols[s] += separating_family.suffixes[id].size();
+		}
+	}
+
+	// For every state t: the number of (state, middle) pairs leading to t, and the total length of
+	// their prefixes. We start with the empty middle sequences.
+	vector<double> pairs(N, 1);
+	vector<double> prefix_symbols(N, 0);
+	for (state s = 0; s < N; ++s) prefix_symbols[s] = prefixes.length[s];
+
+	vector<suite_size> ret(k_max);
+	for (size_t k = 0; k < k_max; ++k) {
+		for (state t = 0; t < N; ++t) {
+			ret[k].tests += pairs[t] * suffixes[t];
+			ret[k].symbols += (prefix_symbols[t] + k * pairs[t]) * suffixes[t] + pairs[t] * suffix_symbols[t];
+		}
+
+		if (k + 1 == k_max) break;
+
+		vector<double> new_pairs(N, 0);
+		vector<double> new_prefix_symbols(N, 0);
+		for (state s = 0; s < N; ++s) {
+			for (input i = 0; i < specification.input_size; ++i) {
+				const auto t = apply(specification, s, i).to;
+				if (t == state(-1)) continue;
+				new_pairs[t] += pairs[s];
+				new_prefix_symbols[t] += prefix_symbols[s];
+			}
+		}
+		pairs.swap(new_pairs);
+		prefix_symbols.swap(new_prefix_symbols);
+	}
+
+	return ret;
+}
+
+// Checks the word w against all tests with middles shorter than k_max. Returns 0 if w is a proper
+// prefix of some test, otherwise the number of tests which are equal to w.
+static size_t number_of_copies(const mealy & specification, const transfer_sequences & prefixes,
+                               const separating_family & separating_family, size_t k_max,
+                               word const & w) {
+	size_t copies = 0;
+
+	// The tests starting with prefix p(s) for a prefix p(s) of w (s at depth d in the tree)
+	const auto check_state = [&](state s, size_t d) {
+		const auto r_size = w.size() - d;
+		for (size_t j = 0; j < k_max; ++j) {
+			// the middle sequence can be chosen to extend w
+			if (r_size < j) return false;
+
+			const auto mid_end = w.begin() + d + j;
+			const auto t = try_apply(specification, s, w.begin() + d, mid_end).to;
+			if (t == state(-1)) continue;
+			const auto rest_size = size_t(w.end() - mid_end);
+			for (auto id : separating_family[t].local_suffixes) {
+				const auto suffix = separating_family.suffixes[id];
+				if (suffix.size() < rest_size) continue;
+				if (!equal(mid_end, w.end(), suffix.begin())) continue;
+				if (suffix.size() > rest_size) return false;
+				copies++;
+			}
+		}
+		return true;
+	};
+
+	// Walk through the tree of transfer sequences along w
+	state current = 0;
+	size_t depth = 0;
+	while (true) {
+		if (!check_state(current, depth)) return 0;
+		if (depth == w.size()) {
+			// w is a proper prefix of the prefix of a child
+			for (input i = 0; i < specification.input_size; ++i) {
+				const auto t = apply(specification, current, i).to;
+				if (t != state(-1) && prefixes.parent[t] == current && prefixes.via[t] == i) return 0;
+			}
+			break;
+		}
+
+		const auto i = w[depth];
+		const auto t = apply(specification, current, i).to;
+		if (t == state(-1) || prefixes.parent[t] != current || prefixes.via[t] != i) break;
+		current = t;
+		depth++;
+	}
+
+	return copies;
+}
+
+suite_size estimate_prefix_free_size(const mealy & specification,
+                                     const transfer_sequences & prefixes,
+                                     const separating_family & separating_family, size_t k_min,
+                                     size_t k_max, size_t samples, uint_fast32_t random_seed) {
+	suite_size ret;
+	if (k_min >= k_max || samples == 0) return ret;
+
+	mt19937 generator(random_seed);
+	uniform_int_distribution<state> state_selection(0, specification.graph_size - 1);
+	uniform_int_distribution<input> input_selection(0, specification.input_size - 1);
+	uniform_int_distribution<size_t> suffix_selection;
+	using params = decltype(suffix_selection)::param_type;
+
+	// We sample every length of the middle sequence equally often. A sample (s, middle, suffix) is
+	// weighted by the number of suffixes it was chosen from, and by the number of equal copies.
+	const auto samples_per_k = max<size_t>(1, samples / (k_max - k_min));
+	const double N = specification.graph_size;
+	word w;
+	word middle;
+	for (size_t k = k_min; k < k_max; ++k) {
+		const double pairs = N * pow(double(specification.input_size), double(k));
+		suite_size level;
+		for (size_t n = 0; n < samples_per_k; ++n) {
+			const auto s = state_selection(generator);
+			middle.resize(k);
+			for (auto & i : middle) i = input_selection(generator);
+			// An undefined middle sequence gives no tests (but it is counted in pairs)
+			const auto t = try_apply(specification, s, middle.begin(), middle.end()).to;
+			if (t == state(-1)) continue;
+
+			const auto & suffixes = separating_family[t].local_suffixes;
+			const auto suffix = separating_family.suffixes[suffixes[suffix_selection(
+			    generator, params{0, suffixes.size() - 1})]];
+
+			prefixes.materialize(s, w);
+			w.insert(w.end(), middle.begin(), middle.end());
+			w.insert(w.end(), suffix.begin(), suffix.end());
+
+			const auto copies
+			    = number_of_copies(specification, prefixes, separating_family, k_max, w);
+			if (copies == 0) continue;
+
+			level.tests += double(suffixes.size()) / copies;
+			level.symbols += double(suffixes.size()) * w.size() / copies;
+		}
+		ret.tests += level.tests * pairs / samples_per_k;
+		ret.symbols += level.symbols * pairs / samples_per_k;
+	}
+
+	return ret;
+}
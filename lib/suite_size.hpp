@@ -0,0 +1,32 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct mealy;
+struct separating_family;
+struct transfer_sequences;
+
+/// \brief The size of a (part of a) test suite: the number of tests and the total number of symbols
+struct suite_size {
+	double tests = 0;
+	double symbols = 0;
+};
+
+/// \brief Computes the exact size of the tests of test(), without generating them.
+/// Entry k of the result is the size of the tests with a middle sequence of length k < \p k_max.
+/// Redundant tests are included. This takes O(k_max * N * P) time, as we only count how many
+/// middle sequences lead to each state.
+std::vector<suite_size> count_tests(mealy const & specification, transfer_sequences const & prefixes,
+                                    separating_family const & separating_family, size_t k_max);
+
+/// \brief Estimates the size of the tests with middle sequences of length in [\p k_min, \p k_max)
+/// after removing tests which are a prefix of another test with a middle shorter than \p k_max (as a
+/// trie would do). A number of tests is sampled, and for each sample we check exactly whether it is
+/// redundant.
+suite_size estimate_prefix_free_size(mealy const & specification,
+                                     transfer_sequences const & prefixes,
+                                     separating_family const & separating_family, size_t k_min,
+                                     size_t k_max, size_t samples, uint_fast32_t random_seed);
@@ -1,7 +1,11 @@
 #include "test_suite.hpp"
+#include "philox.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <random>
+#include <stdexcept>
 
 
 using namespace std;
@@ -9,24 +13,58 @@ using namespace std;
 void test(const mealy & specification, const transfer_sequences & prefixes,
           const separating_family & separating_family, size_t k_max, const writer & output) {
 	vector<word> all_sequences(1);
-        test(specification, prefixes, all_sequences, separating_family, k_max, output);
+	test(specification, prefixes, all_sequences, separating_family, k_max, output);
 }
 
 void test(const mealy & specification, const transfer_sequences & prefixes,
           vector<word> & all_sequences, const separating_family & separating_family,
-          size_t k_max, const writer & output) {
+          size_t k_max, const writer & output, const shard & part) {
+	test_cursor cursor;
+	test(specification, prefixes, all_sequences, separating_family, k_max, output, part, cursor);
+}
+
+void test(const mealy & specification, const transfer_sequences & prefixes,
+          vector<word> & all_sequences, const separating_family & separating_family,
+          size_t k_max, const writer & output, const shard & part, test_cursor & cursor) {
+	word prefix;
+	state prefix_state = state(-1);
+	size_t unit = 0;
 	for (size_t k = 0; k < k_max; ++k) {
+		// When resuming, we skip complete levels and states at once
+		const auto units_per_state = all_sequences.size();
+		if (unit + specification.graph_size * units_per_state <= cursor.unit) {
+			unit += specification.graph_size * units_per_state;
+			all_sequences = all_seqs(0, specification.input_size, all_sequences);
+			continue;
+		}
 
 		for (state s = 0; s < specification.graph_size; ++s) {
-			const auto prefix = prefixes[s];
+			if (unit + units_per_state <= cursor.unit) {
+				unit += units_per_state;
+				continue;
+			}
 
 			for (auto && middle : all_sequences) {
-				const auto t = apply(specification, s, middle.begin(), middle.end()).to;
+				const auto current_unit = unit++;
+				if (current_unit % part.count != part.index) continue;
+				if (current_unit < cursor.unit) continue;
 
-				for (auto && suffix : separating_family[t].local_suffixes) {
+				if (prefix_state != s) {
+					prefixes.materialize(s, prefix);
+					prefix_state = s;
+				}
+
+				// In a partial machine, a middle sequence may not be defined from s
+				const auto t = try_apply(specification, s, middle.begin(), middle.end()).to;
+				if (t == state(-1)) continue;
+				const auto & suffixes = separating_family[t].local_suffixes;
+
+				const auto first = current_unit == cursor.unit ? cursor.suffix : 0;
+				for (size_t j = first; j < suffixes.size(); ++j) {
+					cursor = {current_unit, j + 1};
 					output.apply(prefix);
 					output.apply(middle);
-					output.apply(suffix);
+					output.apply(separating_family.suffixes[suffixes[j]]);
 					if(!output.reset()) return;
 				}
 			}
@@ -34,44 +72,292 @@ void test(const mealy & specification, const transfer_sequences & prefixes,
 
 		all_sequences = all_seqs(0, specification.input_size, all_sequences);
 	}
+
+	cursor = {unit, 0};
+}
+
+// The states ordered by the length of their access sequence (ties by number)
+static vector<state> access_order(const transfer_sequences & prefixes) {
+	vector<state> order(prefixes.size());
+	iota(order.begin(), order.end(), 0);
+	stable_sort(order.begin(), order.end(),
+	            [&](state s, state t) { return prefixes.length[s] < prefixes.length[t]; });
+	return order;
+}
+
+vector<vector<word>> spy_alternatives(const mealy & specification,
+                                      const transfer_sequences & prefixes) {
+	const auto N = specification.graph_size;
+	const auto P = specification.input_size;
+
+	const auto order = access_order(prefixes);
+	vector<size_t> rank(N);
+	for (size_t i = 0; i < N; ++i) rank[order[i]] = i;
+
+	// Convergence is transitive, so the alternatives of r (plus y) are alternatives of s as well.
+	// There may be exponentially many, so we keep a few per state.
+	const size_t max_alternatives = 16;
+	vector<vector<word>> alternatives(N);
+	word prefix;
+	for (auto r : order) {
+		prefixes.materialize(r, prefix);
+		for (input y = 0; y < P; ++y) {
+			const auto s = apply(specification, r, y).to;
+			if (s == state(-1) || rank[r] >= rank[s]) continue;
+			if (prefixes.parent[s] == r && prefixes.via[s] == y) continue;
+			alternatives[s].push_back(prefix);
+			alternatives[s].back().push_back(y);
+			for (size_t i = 0; i < alternatives[r].size(); ++i) {
+				if (alternatives[s].size() >= max_alternatives) break;
+				alternatives[s].push_back(alternatives[r][i]);
+				alternatives[s].back().push_back(y);
+			}
+		}
+	}
+	return alternatives;
+}
+
+void spy_test(const mealy & specification, const transfer_sequences & prefixes,
+              const separating_family & separating_family, size_t k_max, trie<input> & suite) {
+	const auto P = specification.input_size;
+	const auto order = access_order(prefixes);
+	const auto alternatives = spy_alternatives(specification, prefixes);
+
+	word prefix;
+	vector<word> all_sequences(1);
+	word best;
+	word candidate;
+	const auto assign = [](word & w, word const & p, word const & m, word_view e) {
+		w.assign(p.begin(), p.end());
+		w.insert(w.end(), m.begin(), m.end());
+		w.insert(w.end(), e.begin(), e.end());
+	};
+
+	for (size_t k = 0; k < k_max; ++k) {
+		for (auto s : order) {
+			prefixes.materialize(s, prefix);
+			for (auto && middle : all_sequences) {
+				const auto t = try_apply(specification, s, middle.begin(), middle.end()).to;
+				if (t == state(-1)) continue;
+
+				for (auto id : separating_family[t].local_suffixes) {
+					const auto suffix = separating_family.suffixes[id];
+					assign(best, prefix, middle, suffix);
+					auto best_growth = suite.growth(best);
+
+					// The state cover itself has to be tested with its own access sequences
+					if (k > 0) {
+						for (auto const & a : alternatives[s]) {
+							if (best_growth == 0) break;
+							assign(candidate, a, middle, suffix);
+							const auto growth = suite.growth(candidate);
+							if (growth < best_growth) {
+								best.swap(candidate);
+								best_growth = growth;
+							}
+						}
+					}
+
+					suite.insert(best);
+				}
+			}
+		}
+
+		all_sequences = all_seqs(0, P, all_sequences);
+	}
 }
 
 void randomized_test(const mealy & specification, const transfer_sequences & prefixes,
                      const separating_family & separating_family, size_t min_k, size_t rnd_length,
                      const writer & output, uint_fast32_t random_seed) {
-	// clog << "*** K >= " << min_k << endl;
-
 	std::mt19937 generator(random_seed);
+	randomized_test(specification, prefixes, separating_family, min_k, rnd_length, output,
+	                generator);
+}
 
+// Draws a defined input for state s, or returns input(-1) if s has no defined inputs (in a partial
+// machine). For complete machines this is a single draw, so the random tests stay the same.
+template <typename Draw>
+static input draw_defined_input(const mealy & specification, state s, Draw && draw) {
+	auto i = draw();
+	if (apply(specification, s, i).to != state(-1)) return i;
+
+	bool any = false;
+	for (input j = 0; j < specification.input_size && !any; ++j) {
+		any = apply(specification, s, j).to != state(-1);
+	}
+	if (!any) return input(-1);
+
+	while (apply(specification, s, i).to == state(-1)) i = draw();
+	return i;
+}
+
+// Draws a single random test, and returns its suffix (the prefix and middle are stored in the
+// given words). This is shared by the sequential and the counter based generators.
+template <typename Generator>
+static word_view random_test(const mealy & specification, const transfer_sequences & prefixes,
+                             const separating_family & separating_family, size_t min_k,
+                             size_t rnd_length, Generator & generator, word & prefix,
+                             word & middle) {
 	// https://en.wikipedia.org/wiki/Geometric_distribution we have the random variable Y here
 	uniform_int_distribution<> unfair_coin(0, rnd_length);
 	uniform_int_distribution<state> prefix_selection(0, prefixes.size() - 1);
 	uniform_int_distribution<size_t> suffix_selection;
 	uniform_int_distribution<input> input_selection(0, specification.input_size - 1);
 
+	state current_state = 0;
+
+	prefixes.materialize(prefix_selection(generator), prefix);
+	current_state = apply(specification, current_state, begin(prefix), end(prefix)).to;
+
+	middle.clear();
+	size_t minimal_size = min_k;
+	while (minimal_size || unfair_coin(generator)) {
+		const auto i = draw_defined_input(specification, current_state,
+		                                  [&] { return input_selection(generator); });
+		if (i == input(-1)) break;
+		middle.push_back(i);
+		current_state = apply(specification, current_state, i).to;
+		if (minimal_size) minimal_size--;
+	}
+
+	using params = decltype(suffix_selection)::param_type;
+	const auto & suffixes = separating_family[current_state].local_suffixes;
+	return separating_family.suffixes[suffixes[suffix_selection(generator, params{0, suffixes.size() - 1})]];
+}
+
+void randomized_test(const mealy & specification, const transfer_sequences & prefixes,
+                     const separating_family & separating_family, size_t min_k, size_t rnd_length,
+                     const writer & output, std::mt19937 & generator) {
+	// clog << "*** K >= " << min_k << endl;
+
+	word prefix;
+	word middle;
+	middle.reserve(min_k + 1);
 	while (true) {
-		state current_state = 0;
+		const auto suffix = random_test(specification, prefixes, separating_family, min_k,
+		                                rnd_length, generator, prefix, middle);
+
+		output.apply(prefix);
+		output.apply(middle);
+		output.apply(suffix);
+		if(!output.reset()) return;
+	}
+}
+
+void randomized_test(const mealy & specification, const transfer_sequences & prefixes,
+                     const separating_family & separating_family, size_t min_k, size_t rnd_length,
+                     const writer & output, uint_fast32_t random_seed, size_t & next,
+                     size_t step) {
+	word prefix;
+	word middle;
+	middle.reserve(min_k + 1);
+	while (true) {
+		philox generator(random_seed, next);
+		const auto suffix = random_test(specification, prefixes, separating_family, min_k,
+		                                rnd_length, generator, prefix, middle);
+
+		next += step;
+		output.apply(prefix);
+		output.apply(middle);
+		output.apply(suffix);
+		if(!output.reset()) return;
+	}
+}
+
+coverage::coverage(const mealy & specification, const separating_family & separating_family)
+: transitions(specification.graph_size * specification.input_size, 0)
+, suffix_offsets(specification.graph_size + 1, 0) {
+	for (state s = 0; s < specification.graph_size; ++s) {
+		suffix_offsets[s + 1] = suffix_offsets[s] + separating_family[s].local_suffixes.size();
+	}
+	suffixes.assign(suffix_offsets.back(), 0);
+}
 
-		const auto & prefix = prefixes[prefix_selection(generator)];
-		current_state = apply(specification, current_state, begin(prefix), end(prefix)).to;
+void coverage::write(ostream & out) const {
+	out << transitions.size() << ' ' << suffixes.size();
+	for (auto x : transitions) out << ' ' << x;
+	for (auto x : suffixes) out << ' ' << x;
+}
+
+void coverage::read(istream & in) {
+	size_t t_size = 0, s_size = 0;
+	in >> t_size >> s_size;
+	if (!in || t_size != transitions.size() || s_size != suffixes.size())
+		throw runtime_error("Coverage counters do not match the machine");
+	for (auto & x : transitions) in >> x;
+	for (auto & x : suffixes) in >> x;
+	if (!in) throw runtime_error("Could not read coverage counters");
+}
+
+void randomized_test_coverage(const mealy & specification, const transfer_sequences & prefixes,
+                              const separating_family & separating_family, size_t min_k,
+                              size_t rnd_length, const writer & output, std::mt19937 & generator,
+                              coverage & counters) {
+	const auto P = specification.input_size;
 
-		word middle;
-		middle.reserve(min_k + 1);
+	// https://en.wikipedia.org/wiki/Geometric_distribution we have the random variable Y here
+	uniform_int_distribution<> unfair_coin(0, rnd_length);
+	uniform_int_distribution<state> prefix_selection(0, prefixes.size() - 1);
+	uniform_int_distribution<size_t> suffix_selection;
+	uniform_int_distribution<input> input_selection(0, P - 1);
+	using params = decltype(suffix_selection)::param_type;
+
+	// Draws a few candidates, and returns the one with the lowest count (the first on a tie). More
+	// candidates give a stronger bias, but less randomness. Four seems a good balance: full
+	// coverage takes about 5 times fewer tests than with uniform choices.
+	const size_t candidates = 4;
+	const auto least_covered = [candidates](auto && draw, auto && count) {
+		auto best = draw();
+		for (size_t n = 1; n < candidates; ++n) {
+			const auto other = draw();
+			if (count(other) < count(best)) best = other;
+		}
+		return best;
+	};
+
+	// How much a state was tested (as the source of a transition)
+	const auto state_count = [&](state s) {
+		uint64_t n = 0;
+		for (input i = 0; i < P; ++i) n += counters.transitions[s * P + i];
+		return n;
+	};
+
+	word prefix;
+	word middle;
+	middle.reserve(min_k + 1);
+	while (true) {
+		const auto s = least_covered([&] { return prefix_selection(generator); }, state_count);
+		prefixes.materialize(s, prefix);
+		state current_state = s;
+
+		middle.clear();
 		size_t minimal_size = min_k;
 		while (minimal_size || unfair_coin(generator)) {
-			input i = input_selection(generator);
+			// In a state without defined inputs, all draws give input(-1)
+			const auto draw = [&] { return input_selection(generator); };
+			const auto i = least_covered(
+			    [&] { return draw_defined_input(specification, current_state, draw); },
+			    [&](input j) {
+				    return j == input(-1) ? 0 : counters.transitions[current_state * P + j];
+				});
+			if (i == input(-1)) break;
+			counters.transitions[current_state * P + i]++;
 			middle.push_back(i);
 			current_state = apply(specification, current_state, i).to;
 			if (minimal_size) minimal_size--;
 		}
 
-		using params = decltype(suffix_selection)::param_type;
 		const auto & suffixes = separating_family[current_state].local_suffixes;
-		const auto & suffix = suffixes[suffix_selection(generator, params{0, suffixes.size() - 1})];
+		const auto offset = counters.suffix_offsets[current_state];
+		const auto j = least_covered(
+		    [&] { return suffix_selection(generator, params{0, suffixes.size() - 1}); },
+		    [&](size_t k) { return counters.suffixes[offset + k]; });
+		counters.suffixes[offset + j]++;
 
 		output.apply(prefix);
 		output.apply(middle);
-		output.apply(suffix);
+		output.apply(separating_family.suffixes[suffixes[j]]);
 		if(!output.reset()) return;
 	}
 }
@@ -79,22 +365,21 @@ void randomized_test(const mealy & specification, const transfer_sequences & pre
 void randomized_test_suffix(const mealy & specification, const transfer_sequences & prefixes,
                             const separating_family & separating_family, size_t min_k,
                             size_t rnd_length, const writer & output, uint_fast32_t random_seed) {
-	vector<pair<state, word>> all_suffixes;
+	randomized_test_suffix(create_predecessor_index(specification), prefixes, separating_family,
+	                       min_k, rnd_length, output, random_seed);
+}
+
+void randomized_test_suffix(const predecessor_index & predecessors,
+                            const transfer_sequences & prefixes,
+                            const separating_family & separating_family, size_t min_k,
+                            size_t rnd_length, const writer & output, uint_fast32_t random_seed) {
+	vector<pair<state, suffix_id>> all_suffixes;
 	for (state s = 0; s < separating_family.size(); ++s) {
 		for (auto const & w : separating_family[s].local_suffixes) {
 			all_suffixes.emplace_back(s, w);
 		}
 	}
 
-	// state -> [(input, state)]
-	vector<vector<pair<input, state>>> reverse_machine(specification.graph_size);
-	for (state s = 0; s < specification.graph_size; ++s) {
-		for (input i = 0; i < specification.input_size; ++i) {
-			const auto t = apply(specification, s, i).to;
-			reverse_machine[t].emplace_back(i, s);
-		}
-	}
-
 	std::mt19937 generator(random_seed);
 
 	// https://en.wikipedia.org/wiki/Geometric_distribution we have the random variable Y here
@@ -102,32 +387,36 @@ void randomized_test_suffix(const mealy & specification, const transfer_sequence
 	uniform_int_distribution<state> suffix_selection(0, all_suffixes.size() - 1);
 	uniform_int_distribution<size_t> input_selection;
 
+	word prefix;
+	word middle;
+	middle.reserve(min_k + 1);
 	while (true) {
 		const auto & state_suffix = all_suffixes[suffix_selection(generator)];
-		const auto & suffix = state_suffix.second;
+		const auto suffix = separating_family.suffixes[state_suffix.second];
 		state current_state = state_suffix.first;
 
-		word middle;
-		middle.reserve(min_k + 1);
+		// We walk backwards, so the middle is built in reverse
+		middle.clear();
 		size_t minimal_size = min_k;
 		while (minimal_size || unfair_coin(generator)) {
-			const auto & preds = reverse_machine[current_state];
-			if(preds.empty()) {
+			const auto number_of_preds = predecessors.size(current_state);
+			if(number_of_preds == 0) {
 				cerr << "ERROR: no predecessors for this state!\n";
 				break;
 			}
 
 			using params = decltype(input_selection)::param_type;
 			const auto & input_state
-			    = preds[input_selection(generator, params{0, preds.size() - 1})];
+			    = predecessors(current_state, input_selection(generator, params{0, number_of_preds - 1}));
 
 			current_state = input_state.second;
-			middle.insert(middle.begin(), input_state.first);
+			middle.push_back(input_state.first);
 
 			if (minimal_size) minimal_size--;
 		}
+		reverse(middle.begin(), middle.end());
 
-		const auto & prefix = prefixes[current_state];
+		prefixes.materialize(current_state, prefix);
 
 		output.apply(prefix);
 		output.apply(middle);
@@ -137,7 +426,7 @@ void randomized_test_suffix(const mealy & specification, const transfer_sequence
 }
 
 writer default_writer(std::vector<std::string> const & inputs, std::ostream & os) {
-	static const auto print_word = [&](word w) {
+	static const auto print_word = [&](word_view w) {
 		for (auto && x : w) os << inputs[x] << ' ';
 	};
 	static const auto reset = [&] {
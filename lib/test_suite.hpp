@@ -3,32 +3,116 @@
 #include "mealy.hpp"
 #include "separating_family.hpp"
 #include "transfer_sequences.hpp"
+#include "trie.hpp"
 #include "types.hpp"
 
+#include <cstdint>
 #include <functional>
+#include <iosfwd>
+#include <random>
 #include <vector>
 
 struct writer {
-	std::function<void(word)> apply; // store a part of a word
+	std::function<void(word_view)> apply; // store a part of a word
 	std::function<bool(void)> reset; // flush, if flase is returned, testing is stopped
 };
 
+/// \brief Selects a part of the exhaustive tests, so that several nodes can generate a suite.
+/// The (state, middle) pairs are enumerated and dealt to the \p count shards in turn. So the shards
+/// are disjoint, and together they give all tests.
+struct shard {
+	size_t index = 0;
+	size_t count = 1;
+};
+
+/// \brief A position in the enumeration of test(), such that generation can be resumed.
+/// The (state, middle) pairs are numbered as for the shards, \p suffix indexes the local suffixes.
+struct test_cursor {
+	size_t unit = 0;
+	size_t suffix = 0;
+};
+
 /// \brief Performs exhaustive tests with mid sequences < \p k_max (harmonized, e.g. HSI / DS)
 void test(mealy const & specification, transfer_sequences const & prefixes,
           separating_family const & separating_family, size_t k_max, writer const & output);
 
 void test(const mealy & specification, const transfer_sequences & prefixes,
           std::vector<word> & all_sequences, const separating_family & separating_family,
-          size_t k_max, const writer & output);
+          size_t k_max, const writer & output, shard const & part = shard{});
+
+/// \brief Same as above, but starts at \p cursor, and keeps it pointed at the next test.
+void test(const mealy & specification, const transfer_sequences & prefixes,
+          std::vector<word> & all_sequences, const separating_family & separating_family,
+          size_t k_max, const writer & output, shard const & part, test_cursor & cursor);
+
+/// \brief Adds the exhaustive tests with mid sequences < \p k_max to \p suite, with the prefixes
+/// chosen as in the SPY method (Simao, Petrenko and Yevtushenko). The tests with an empty middle
+/// start with the access sequence of their state, as in test(). For the other tests, the access
+/// sequence of a state s may be replaced by a sequence which converges to it: an access sequence
+/// of an earlier state r plus an input from r to s. (Earlier in order of the access sequences, so
+/// that the convergence of this transition is shown by tests of r.) Of these, we take the one
+/// for which \p suite grows the least, so that tests often extend each other.
+void spy_test(mealy const & specification, transfer_sequences const & prefixes,
+              separating_family const & separating_family, size_t k_max, trie<input> & suite);
+
+/// \brief The sequences which spy_test may use instead of the access sequence of each state (at
+/// most 16 per state). States are ordered by the length of their access sequence (ties by number).
+std::vector<std::vector<word>> spy_alternatives(mealy const & specification,
+                                                transfer_sequences const & prefixes);
 
 /// \brief Performs random non-exhaustive tests for more states (harmonized, e.g. HSI / DS)
 void randomized_test(mealy const & specification, transfer_sequences const & prefixes,
                      separating_family const & separating_family, size_t min_k, size_t rnd_length,
                      writer const & output, uint_fast32_t random_seed);
 
+/// \brief Same as above, with a given generator (e.g. to save and restore its state).
+void randomized_test(mealy const & specification, transfer_sequences const & prefixes,
+                     separating_family const & separating_family, size_t min_k, size_t rnd_length,
+                     writer const & output, std::mt19937 & generator);
+
+/// \brief Same as above, but test number i only depends on the seed and on i (by means of a counter
+/// based generator). Generates the tests \p next, \p next + \p step, ..., and keeps \p next
+/// pointed at the next test. So any test can be reproduced directly, and the stream can be split.
+void randomized_test(mealy const & specification, transfer_sequences const & prefixes,
+                     separating_family const & separating_family, size_t min_k, size_t rnd_length,
+                     writer const & output, uint_fast32_t random_seed, size_t & next,
+                     size_t step = 1);
+
+/// \brief Counts how often the random tests exercised each transition (in the middle sequence) and
+/// each (state, suffix) pair. Used to steer the random tests towards what is not tested yet.
+struct coverage {
+	coverage(mealy const & specification, separating_family const & separating_family);
+
+	// The random part runs forever, so the counters are 64 bits (32 bits could wrap around, and
+	// then the most tested transitions would look untested)
+	std::vector<std::uint64_t> transitions; // state * input_size + input
+	std::vector<size_t> suffix_offsets;     // state -> start of its pairs in suffixes
+	std::vector<std::uint64_t> suffixes;    // suffix_offsets[state] + index of the local suffix
+
+	/// \brief Writes the counters to \p out, such that they can be read back with read()
+	void write(std::ostream & out) const;
+	/// \brief Reads the counters, as written by write(), the sizes should match
+	void read(std::istream & in);
+};
+
+/// \brief Same as randomized_test, but biased towards transitions and suffixes which are tested
+/// the least (as recorded in \p counters). Every choice is made by drawing a few candidates
+/// uniformly, and taking the least covered one. So the tests are still random and seedable.
+void randomized_test_coverage(mealy const & specification, transfer_sequences const & prefixes,
+                              separating_family const & separating_family, size_t min_k,
+                              size_t rnd_length, writer const & output, std::mt19937 & generator,
+                              coverage & counters);
+
+/// \brief Performs random tests by first choosing a suffix, and then walking backwards
 void randomized_test_suffix(mealy const & specification, transfer_sequences const & prefixes,
                             separating_family const & separating_family, size_t min_k,
                             size_t rnd_length, writer const & output, uint_fast32_t random_seed);
 
+/// \brief Same as above, with a predecessor index which is already built
+void randomized_test_suffix(predecessor_index const & predecessors,
+                            transfer_sequences const & prefixes,
+                            separating_family const & separating_family, size_t min_k,
+                            size_t rnd_length, writer const & output, uint_fast32_t random_seed);
+
 /// \brief returns a writer which simply writes everything to cout (via inputs)
 writer default_writer(const std::vector<std::string> & inputs, std::ostream & os);
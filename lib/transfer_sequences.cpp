@@ -3,10 +3,12 @@
 #include "mealy.hpp"
 
 #include <algorithm>
-#include <numeric>
+#include <cmath>
 #include <deque>
+#include <numeric>
 #include <random>
 #include <tuple>
+#include <vector>
 
 using namespace std;
 
@@ -16,6 +18,87 @@ static size_t clamp_to_size_t(double x, size_t min, size_t max) {
 	if (x <= min) return min;
 	return x;
 }
+
+// The work list of the search, from which we sample by position (in order of insertion). When we
+// always take the front (bfs) or the back (dfs), a deque suffices. For other positions we use a
+// Fenwick tree over the insertion slots, so that the element of a given rank can be found and
+// removed in O(log n), instead of erasing from the middle of a deque.
+struct work_list {
+	work_list(size_t capacity, bool ranked) : ranked(ranked) {
+		if (!ranked) return;
+		elements.resize(capacity);
+		tree.resize(capacity + 1, 0);
+		top_step = 1;
+		while (2 * top_step <= capacity) top_step *= 2;
+	}
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	void push_back(state s) {
+		count++;
+		if (!ranked) {
+			ends.push_back(s);
+			return;
+		}
+		elements[pushed] = s;
+		add(pushed++, 1);
+	}
+
+	state take(size_t rank) {
+		count--;
+		if (!ranked) {
+			state ret;
+			if (rank == 0) {
+				ret = ends.front();
+				ends.pop_front();
+			} else {
+				ret = ends.back();
+				ends.pop_back();
+			}
+			return ret;
+		}
+		const auto slot = find(rank);
+		add(slot, -1);
+		return elements[slot];
+	}
+
+  private:
+	void add(size_t slot, int delta) {
+		for (size_t i = slot + 1; i < tree.size(); i += i & (~i + 1)) tree[i] += delta;
+	}
+
+	// smallest slot such that the number of elements up to (and including) it exceeds rank
+	size_t find(size_t rank) const {
+		size_t pos = 0;
+		size_t remaining = rank + 1;
+		for (size_t step = top_step; step > 0; step /= 2) {
+			if (pos + step < tree.size() && size_t(tree[pos + step]) < remaining) {
+				pos += step;
+				remaining -= tree[pos];
+			}
+		}
+		return pos;
+	}
+
+	bool ranked;
+	size_t count = 0;
+	deque<state> ends;
+
+	vector<state> elements;
+	vector<int> tree;
+	size_t pushed = 0;
+	size_t top_step = 0;
+};
+}
+
+void transfer_sequences::materialize(state s, word & w) const {
+	w.resize(length[s]);
+	auto it = w.rbegin();
+	while (it != w.rend()) {
+		*it++ = via[s];
+		s = parent[s];
+	}
 }
 
 transfer_sequences create_transfer_sequences(transfer_options const & opt, const mealy & machine,
@@ -24,39 +107,37 @@ transfer_sequences create_transfer_sequences(transfer_options const & opt, const
 	uniform_real_distribution<double> dist(opt.q_min, opt.q_max);
 
 	vector<bool> added(machine.graph_size, false);
-	vector<word> words(machine.graph_size);
+	transfer_sequences ret;
+	ret.parent.assign(machine.graph_size, state(-1));
+	ret.via.assign(machine.graph_size, input(-1));
+	ret.length.assign(machine.graph_size, 0);
 	vector<input> all_inputs(machine.input_size);
 	iota(begin(all_inputs), end(all_inputs), input(0));
 
-	deque<state> work(1, s);
+	// Positions in [q_min, q_max] are clamped, so these cases only touch the ends
+	const bool only_ends = opt.q_max <= 0.0 || opt.q_min >= 1.0;
+	work_list work(machine.graph_size, !only_ends);
+	work.push_back(s);
 	added[s] = true;
 	while (!work.empty()) {
-		const auto u = [&] {
-			// get the place in the array to pop a state
-			const auto sample = dist(generator);
-			const auto scaled_sample = clamp_to_size_t(floor(work.size() * sample), 0, work.size()-1);
-			const auto it = work.begin() + scaled_sample;
-			// get the element
-			const auto ret = *it;
-			// pop it
-			work.erase(it);
-			// return it
-			return ret;
-		}();
+		// get the place in the list to pop a state
+		const auto sample = dist(generator);
+		const auto u = work.take(clamp_to_size_t(floor(work.size() * sample), 0, work.size() - 1));
 
 		// NOTE: we could also shuffle work, but we would need to do this per distance
 		// the current shuffle is an approximation of real randomization, but easier to implement.
 		if (opt.randomized) shuffle(begin(all_inputs), end(all_inputs), generator);
 		for (input i : all_inputs) {
 			const auto v = apply(machine, u, i).to;
-			if (added[v]) continue;
+			if (v == state(-1) || added[v]) continue;
 
 			work.push_back(v);
 			added[v] = true;
-			words[v] = words[u];
-			words[v].push_back(i);
+			ret.parent[v] = u;
+			ret.via[v] = i;
+			ret.length[v] = ret.length[u] + 1;
 		}
 	}
 
-	return words;
+	return ret;
 }
@@ -4,8 +4,26 @@
 
 struct mealy;
 
-// state -> sequence going to that state
-using transfer_sequences = std::vector<word>;
+/// \brief The transfer sequences (state -> sequence going to that state).
+/// The sequences form a tree rooted in the start state, so we only store for each state its parent
+/// and the input from the parent. This takes O(N) memory, regardless of the lengths. Sequences are
+/// materialized on demand.
+struct transfer_sequences {
+	std::vector<state> parent; // state(-1) for the root
+	std::vector<input> via;
+	std::vector<size_t> length;
+
+	size_t size() const { return parent.size(); }
+
+	/// \brief Writes the sequence for state \p s into \p w (overwriting its contents)
+	void materialize(state s, word & w) const;
+
+	word operator[](state s) const {
+		word w;
+		materialize(s, w);
+		return w;
+	}
+};
 
 struct transfer_options {
 	// range used to sample the work-queue. [0,0] is a bfs (minimal), [1,1] is a dfs (dumb).
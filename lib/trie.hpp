@@ -1,7 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <istream>
+#include <iterator>
 #include <memory>
+#include <ostream>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
@@ -38,6 +42,18 @@ template <typename T> struct trie {
 	/// \returns true if the element was inserted, false if already there
 	template <typename Range> bool insert(Range const & r) { return insert(begin(r), end(r)); }
 
+	/// \brief The number of symbols by which the words (not the prefixes) grow when inserting the
+	/// word given by \p begin and \p end: none if it is a prefix of a word, the new symbols if it
+	/// extends a word, and its whole length otherwise.
+	template <typename Iterator> size_t growth(Iterator begin, Iterator end) const {
+		const auto length = size_t(std::distance(begin, end));
+		if (!node) return length;
+		return node->growth(begin, end, length);
+	}
+
+	/// \brief Same as above, with a range \p r
+	template <typename Range> size_t growth(Range const & r) const { return growth(begin(r), end(r)); }
+
 	/// \brief Applies \p function to all word (not to the prefixes)
 	template <typename Fun> void for_each(Fun && function) const {
 		if (node) {
@@ -47,9 +63,37 @@ template <typename T> struct trie {
 		}
 	}
 
+	/// \brief Walks through the trie as a tree, such that every shared prefix is visited once.
+	/// Chains of nodes with a single child are compressed (as in a radix tree): \p run is called with
+	/// the symbols of such a chain. A node with n children calls \p push before the first n - 1
+	/// children, and \p pop after them. So push/pop can be seen as taking and restoring a snapshot.
+	template <typename Run, typename Push, typename Pop>
+	void for_each_branch(Run && run, Push && push, Pop && pop) const {
+		if (!node) return;
+		std::vector<T> word;
+		node->for_each_branch(run, push, pop, word);
+	}
+
 	/// \brief Empties the complete set
 	void clear() { node.reset(nullptr); }
 
+	/// \brief Writes the structure to \p out, such that it can be read back with read()
+	/// The nodes are written in pre-order, each node as its number of children followed by the
+	/// children (as symbol and node). This is much smaller than writing all words.
+	void write(std::ostream & out) const {
+		out << (node ? 1 : 0);
+		if (node) node->write(out);
+		out << '\n';
+	}
+
+	/// \brief Replaces the contents by the structure in \p in, as written by write()
+	void read(std::istream & in) {
+		int non_empty = 0;
+		if (!(in >> non_empty)) throw std::runtime_error("Could not read trie");
+		node.reset(non_empty ? new trie_node() : nullptr);
+		if (node) node->read(in);
+	}
+
   private:
 	struct trie_node;
 	std::unique_ptr<trie_node> node = nullptr;
@@ -72,11 +116,65 @@ template <typename T> struct trie {
 			return true;
 		}
 
+		template <typename Iterator>
+		size_t growth(Iterator begin, Iterator end, size_t length) const {
+			auto n = this;
+			for (; begin != end; ++begin) {
+				const auto it = n->find(*begin);
+				if (it == n->data.end() || it->first != *begin) break;
+				n = &it->second;
+			}
+
+			if (begin == end) return 0;
+			return n->data.empty() ? size_t(std::distance(begin, end)) : length;
+		}
+
 		template <typename Fun> void for_each(Fun && function) const {
 			std::vector<T> word;
 			return for_each_impl(std::forward<Fun>(function), word);
 		}
 
+		void write(std::ostream & out) const {
+			out << ' ' << data.size();
+			for (auto const & kv : data) {
+				out << ' ' << kv.first;
+				kv.second.write(out);
+			}
+		}
+
+		void read(std::istream & in) {
+			size_t size = 0;
+			if (!(in >> size)) throw std::runtime_error("Could not read trie");
+			data.resize(size);
+			for (auto & kv : data) {
+				if (!(in >> kv.first)) throw std::runtime_error("Could not read trie");
+				kv.second.read(in);
+			}
+		}
+
+		// word contains the symbols leading to this node, which are not yet given to run
+		template <typename Run, typename Push, typename Pop>
+		void for_each_branch(Run & run, Push & push, Pop & pop, std::vector<T> & word) const {
+			auto n = this;
+			while (n->data.size() == 1) {
+				word.push_back(n->data.front().first);
+				n = &n->data.front().second;
+			}
+
+			if (!word.empty()) {
+				const auto & cword = word;
+				run(cword);
+			}
+
+			for (size_t i = 0; i < n->data.size(); ++i) {
+				const bool last = i + 1 == n->data.size();
+				if (!last) push();
+				word.assign(1, n->data[i].first);
+				n->data[i].second.for_each_branch(run, push, pop, word);
+				if (!last) pop();
+			}
+		}
+
 	  private:
 		template <typename Fun> void for_each_impl(Fun && function, std::vector<T> & word) const {
 			if (data.empty()) {
@@ -99,6 +197,12 @@ template <typename T> struct trie {
 			    [](std::pair<T, trie_node> const & kv, T const & k) { return kv.first < k; });
 		}
 
+		typename std::vector<std::pair<T, trie_node>>::const_iterator find(T const & key) const {
+			return std::lower_bound(
+			    data.begin(), data.end(), key,
+			    [](std::pair<T, trie_node> const & kv, T const & k) { return kv.first < k; });
+		}
+
 		std::vector<std::pair<T, trie_node>> data;
 	};
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -10,6 +11,26 @@ using output = std::uint16_t;
 
 using word = std::vector<input>;
 
+// A non-owning view on a word, which is stored elsewhere (e.g. in a pool of words)
+struct word_view {
+	word_view() = default;
+	word_view(input const * b, input const * e) : b(b), e(e) {}
+	word_view(word const & w) : b(w.data()), e(w.data() + w.size()) {}
+
+	input const * begin() const { return b; }
+	input const * end() const { return e; }
+	size_t size() const { return size_t(e - b); }
+	bool empty() const { return b == e; }
+	input operator[](size_t i) const { return b[i]; }
+
+  private:
+	input const * b = nullptr;
+	input const * e = nullptr;
+};
+
+inline input const * begin(word_view w) { return w.begin(); }
+inline input const * end(word_view w) { return w.end(); }
+
 // concattenation of words
 template <typename T>
 std::vector<T> concat(std::vector<T> const & l, std::vector<T> const & r){
@@ -0,0 +1,105 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+extern "C" {
+#include <windows_getopt.h>
+}
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char USAGE[] =
+    R"(Decode a front coded test suite (generated with main -w front or -w front-id).
+
+    Usage:
+      decode_suite [options] [<filename>]
+
+    Options:
+      -h             Show this screen
+
+    Reads from stdin if no filename is given. Outputs one test per line.
+)";
+
+// Decodes the stream, a header line (re)starts a stream, so that concatenations work
+static void decode(istream & in) {
+	vector<string> names;  // empty if the symbols are written by name
+	bool started = false;
+	vector<string> current;
+
+	string line;
+	while (getline(in, line)) {
+		stringstream ss(line);
+		string first;
+		if (!(ss >> first)) continue;
+
+		if (first == "front" || first == "front-id") {
+			names.clear();
+			if (first == "front-id") {
+				size_t n = 0;
+				if (!(ss >> n)) throw runtime_error("Could not read the symbol table");
+				names.resize(n);
+				for (auto & name : names) {
+					if (!(ss >> name)) throw runtime_error("Could not read the symbol table");
+				}
+			}
+			current.clear();
+			started = true;
+			continue;
+		}
+
+		if (!started) throw runtime_error("Not a front coded suite (the header is missing)");
+
+		const auto shared = stoul(first);
+		if (shared > current.size()) throw runtime_error("Invalid shared length: " + first);
+		current.resize(shared);
+
+		string symbol;
+		while (ss >> symbol) {
+			if (names.empty()) {
+				current.push_back(symbol);
+			} else {
+				const auto id = stoul(symbol);
+				if (id >= names.size()) throw runtime_error("Unknown symbol id: " + symbol);
+				current.push_back(names[id]);
+			}
+		}
+
+		for (auto && x : current) cout << x << ' ';
+		cout << '\n';
+	}
+	cout << flush;
+}
+
+int main(int argc, char * argv[]) try {
+	int c;
+	while ((c = getopt(argc, argv, "h")) != -1) {
+		switch (c) {
+		case 'h':
+			cout << USAGE << endl;
+			return 0;
+		default:
+			cerr << "Please use -h to see the available options." << endl;
+			return 2;
+		}
+	}
+
+	if (optind < argc) {
+		ifstream file(argv[optind]);
+		if (!file) throw runtime_error(string("Could not open ") + argv[optind]);
+		decode(file);
+	} else {
+		decode(cin);
+	}
+	return 0;
+} catch (exception const & e) {
+	cerr << "Exception thrown: " << e.what() << endl;
+	return 1;
+}
@@ -1,19 +1,32 @@
 #include <adaptive_distinguishing_sequence.hpp>
+#include <checking_sequence.hpp>
+#include <checkpoint.hpp>
+#include <family_search.hpp>
+#include <input_classes.hpp>
 #include <logging.hpp>
 #include <mealy.hpp>
+#include <minimization.hpp>
 #include <reachability.hpp>
 #include <read_mealy.hpp>
+#include <renumbering.hpp>
 #include <separating_family.hpp>
+#include <server.hpp>
+#include <shortest_separators.hpp>
 #include <splitting_tree.hpp>
+#include <suite_formats.hpp>
+#include <suite_size.hpp>
 #include <test_suite.hpp>
 #include <transfer_sequences.hpp>
 #include <trie.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <csignal>
 #include <cstdlib>
 #include <iostream>
 #include <map>
 #include <random>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -43,54 +56,113 @@ static const char USAGE[] =
     Options:
       -h             Show this screen
       -v             Show version
-      -m <arg>       Operation mode: all, fixed, random
-      -p <arg>       How to generate prefixes: minimal, lexmin, buggy, longest
+      -m <arg>       Operation mode: all, fixed, random, plan, checking, server
+      -p <arg>       How to generate prefixes: minimal, lexmin, buggy, longest, spy (tests of
+                     the fixed part share prefixes which converge to the same state)
       -s <arg>       How to generate suffixes: hsi, hads, none
       -k <num>       Number of extra states to check for (minus 1)
       -l <num>       (l <= k) Redundancy free part of tests
       -r <num>       Expected length of random infix word
       -x <seed>      32 bits seeds for deterministic execution (0 is not valid)
       -e             More memory efficient
+      -q             Minimize the machine first (equivalent states are merged)
+      -d <arg>       Separating sequences of pairs: hopcroft, shortest (as short as possible)
+      -b <num>       Try this many randomized separating families, keep the smallest suite
+      -n <arg>       Numbering of states: bfs, cm (Cuthill-McKee, for locality)
+      -a <arg>       Inputs with identical transitions: keep, merge, sample (merge, but output
+                     a random input of the class every time)
+      -g <arg>       Random generator for the random part: mt19937, philox
+      -i <num>       Index of the first random test (only for philox)
+      -t <arg>       Choices in the random part: uniform, coverage
+      -w <arg>       Output format: lines, tree (only with -m fixed), front, front-id
+      -S <i/n>       Only generate shard i (of n) of the fixed part
+      -c <filename>  Periodically write a checkpoint to this file
+      -R             Resume from the checkpoint given by -c. Tests which may not have been
+                     read by the consumer are written again: tests can be repeated, not lost
+      -u <filename>  Serve on this Unix domain socket (with -m server, default stdin)
       -f <filename>  Input filename ('-' or don't specify for stdin)
       -o <filename>  Output filename ('-' or don't specify for stdout)
 )";
 
-enum Mode { ALL, FIXED, RANDOM, WSET };
-enum PrefixMode { MIN, LEXMIN, BUGGY, DFS };
+enum Mode { ALL, FIXED, RANDOM, WSET, PLAN, CHECKING, SERVER };
+enum PrefixMode { MIN, LEXMIN, BUGGY, DFS, SPY };
 enum SuffixMode { HSI, HADS, NOSUFFIX };
+enum GeneratorMode { MERSENNE, PHILOX };
+enum RandomMode { UNIFORM, COVERAGE };
+enum OutputFormat { LINES, TREE, FRONT, FRONT_IDS };
+enum Separators { HOPCROFT_SEPARATORS, SHORTEST_SEPARATORS };
+enum Numbering { BFS_ORDER, CUTHILL_MCKEE };
+enum Alphabet { KEEP_INPUTS, MERGE_INPUTS, SAMPLE_INPUTS };
 
 struct main_options {
 	bool help = false;
 	bool version = false;
 
 	bool skip_dup = true;
+	bool minimize = false;
 
 	Mode mode = ALL;
 	PrefixMode prefix_mode = MIN;
 	SuffixMode suffix_mode = HADS;
+	GeneratorMode generator_mode = MERSENNE;
+	RandomMode random_mode = UNIFORM;
+	OutputFormat format = LINES;
+	Separators separators = HOPCROFT_SEPARATORS;
+	Numbering numbering = BFS_ORDER;
+	Alphabet alphabet = KEEP_INPUTS;
 
 	unsigned long k_max = 3;      // 3 means 2 extra states
 	unsigned long l = 2;          // length 0, 1 will be redundancy free
 	unsigned long rnd_length = 8; // in addition to k_max
 	unsigned long seed = 0;       // 0 for unset/noise
+	unsigned long tries = 1;      // randomized separating families to choose from
+	shard part;                   // the whole suite by default
+
+	unsigned long first_random_test = 0; // only with philox
+
+	string socket_path; // empty for stdin/stdout
+
+	string checkpoint_filename; // empty for no checkpoints
+	bool resume = false;
 
 	string input_filename;  // empty for stdin
 	string output_filename; // empty for stdout
 };
 
-main_options parse_options(int argc, char ** argv) {
+// Parses the options, throws if they are invalid
+static main_options read_options(int argc, char ** argv) {
 	main_options opts;
 
 	static const map<string, Mode> mode_names = {
-	    {"all", ALL}, {"fixed", FIXED}, {"random", RANDOM}, {"wset", WSET}};
+	    {"all", ALL}, {"fixed", FIXED}, {"random", RANDOM}, {"wset", WSET}, {"plan", PLAN},
+	    {"checking", CHECKING}, {"server", SERVER}};
 	static const map<string, PrefixMode> prefix_names = {
-	    {"minimal", MIN}, {"lexmin", LEXMIN}, {"buggy", BUGGY}, {"longest", DFS}};
+	    {"minimal", MIN}, {"lexmin", LEXMIN}, {"buggy", BUGGY}, {"longest", DFS}, {"spy", SPY}};
 	static const map<string, SuffixMode> suffix_names = {
 	    {"hsi", HSI}, {"hads", HADS}, {"none", NOSUFFIX}};
+	static const map<string, GeneratorMode> generator_names = {
+	    {"mt19937", MERSENNE}, {"philox", PHILOX}};
+	static const map<string, RandomMode> random_names = {
+	    {"uniform", UNIFORM}, {"coverage", COVERAGE}};
+	static const map<string, OutputFormat> format_names = {
+	    {"lines", LINES}, {"tree", TREE}, {"front", FRONT}, {"front-id", FRONT_IDS}};
+	static const map<string, Separators> separator_names = {
+	    {"hopcroft", HOPCROFT_SEPARATORS}, {"shortest", SHORTEST_SEPARATORS}};
+	static const map<string, Numbering> numbering_names = {
+	    {"bfs", BFS_ORDER}, {"cm", CUTHILL_MCKEE}};
+	static const map<string, Alphabet> alphabet_names = {
+	    {"keep", KEEP_INPUTS}, {"merge", MERGE_INPUTS}, {"sample", SAMPLE_INPUTS}};
+
+	// The options of a server session are parsed again later, so we reset getopt
+#ifdef __GLIBC__
+	optind = 0;
+#else
+	optind = 1;
+#endif
 
-	try {
+	{
 		int c;
-		while ((c = getopt(argc, argv, "hvem:p:s:k:l:r:x:f:o:")) != -1) {
+		while ((c = getopt(argc, argv, "hveqd:b:n:a:m:p:s:k:l:r:x:g:i:t:w:u:f:o:S:c:R")) != -1) {
 			switch (c) {
 			case 'h': // show help message
 				opts.help = true;
@@ -122,6 +194,52 @@ main_options parse_options(int argc, char ** argv) {
 			case 'e':
 				opts.skip_dup = false;
 				break;
+			case 'q': // minimize
+				opts.minimize = true;
+				break;
+			case 'd': // separating sequences
+				opts.separators = separator_names.at(optarg);
+				break;
+			case 'b': // tries for the separating family
+				opts.tries = stoul(optarg);
+				break;
+			case 'n': // numbering of states
+				opts.numbering = numbering_names.at(optarg);
+				break;
+			case 'a': // identical inputs
+				opts.alphabet = alphabet_names.at(optarg);
+				break;
+			case 'g': // random generator
+				opts.generator_mode = generator_names.at(optarg);
+				break;
+			case 'i': // first random test
+				opts.first_random_test = stoul(optarg);
+				break;
+			case 't': // random choices
+				opts.random_mode = random_names.at(optarg);
+				break;
+			case 'w': // output format
+				opts.format = format_names.at(optarg);
+				break;
+			case 'S': { // shard
+				const string arg = optarg;
+				const auto slash = arg.find('/');
+				if (slash == string::npos) throw runtime_error("Shard should be given as i/n");
+				opts.part.index = stoul(arg.substr(0, slash));
+				opts.part.count = stoul(arg.substr(slash + 1));
+				if (opts.part.index >= opts.part.count)
+					throw runtime_error("Shard index should be smaller than the number of shards");
+				break;
+			}
+			case 'u': // socket of the server
+				opts.socket_path = optarg;
+				break;
+			case 'c': // checkpoint filename
+				opts.checkpoint_filename = optarg;
+				break;
+			case 'R': // resume from checkpoint
+				opts.resume = true;
+				break;
 			case 'f': // input filename
 				opts.input_filename = optarg;
 				break;
@@ -134,17 +252,127 @@ main_options parse_options(int argc, char ** argv) {
 				throw runtime_error(string("Unrecognised option -") + char(optopt));
 			}
 		}
+	}
+
+	if (opts.first_random_test != 0 && opts.generator_mode != PHILOX)
+		throw runtime_error("Starting at a given random test needs the philox generator (-g philox).");
+
+	if (opts.random_mode == COVERAGE && opts.generator_mode != MERSENNE)
+		throw runtime_error("Coverage guided tests depend on all earlier tests, so need -g mt19937.");
+
+	if (opts.format == TREE && (opts.mode != FIXED || !opts.checkpoint_filename.empty()))
+		throw runtime_error("The tree output is only for the fixed part (-m fixed), without checkpoints.");
+
+	if (opts.alphabet == SAMPLE_INPUTS && opts.format == TREE)
+		throw runtime_error("The tree output shares prefixes, so inputs cannot be sampled (-a sample).");
+
+	if (opts.tries > 1 && (opts.mode == WSET || opts.mode == SERVER))
+		throw runtime_error("Separating families are chosen by the size of the suite, so -b needs a test suite.");
+
+	if (opts.prefix_mode == SPY && (opts.mode == PLAN || opts.mode == SERVER || opts.part.count > 1))
+		throw runtime_error("The SPY method needs the whole fixed part at once, so no -m plan, -m server or -S.");
+
+	if (opts.resume && opts.checkpoint_filename.empty())
+		throw runtime_error("Resuming needs a checkpoint file (-c).");
+
+	// With SPY, the complete fixed part is collected first
+	opts.l = opts.prefix_mode == SPY ? opts.k_max : min(opts.l, opts.k_max);
+	return opts;
+}
+
+main_options parse_options(int argc, char ** argv) {
+	try {
+		return read_options(argc, argv);
 	} catch (exception & e) {
 		cerr << e.what() << endl;
 		cerr << "Could not parse command line options." << endl;
 		cerr << "Please use -h to see the available options." << endl;
 		exit(2);
 	}
+}
 
-	opts.l = min(opts.l, opts.k_max);
-	return opts;
+static transfer_options prefix_options(PrefixMode mode) {
+	switch (mode) {
+	case LEXMIN:
+		return canonical_transfer_sequences;
+	case MIN:
+		return minimal_transfer_sequences;
+	case BUGGY:
+		return buggy_transfer_sequences;
+	case DFS:
+		return longest_transfer_sequences;
+	case SPY: // the prefixes of the state cover, others are derived from those
+		return minimal_transfer_sequences;
+	}
+	throw logic_error("Unknown prefix mode");
 }
 
+// The options of a session of the server, the output options are not used
+static session_options to_session_options(main_options const & opts) {
+	if (opts.mode != ALL && opts.mode != FIXED && opts.mode != RANDOM && opts.mode != SERVER)
+		throw runtime_error("Only the modes all, fixed and random can be used in a server");
+	if (opts.alphabet != KEEP_INPUTS)
+		throw runtime_error("Inputs cannot be merged in a server, as hypotheses change");
+	// The options below are not supported by a session, we refuse them instead of ignoring them
+	if (opts.random_mode == COVERAGE)
+		throw runtime_error("Coverage guided tests (-t coverage) cannot be used in a server");
+	if (opts.format != LINES)
+		throw runtime_error("A server sends tests as lines, so -w cannot be used");
+	if (opts.part.count > 1)
+		throw runtime_error("A server generates the whole suite, so -S cannot be used");
+	if (opts.tries > 1)
+		throw runtime_error("Separating families cannot be searched (-b) in a server");
+	if (opts.prefix_mode == SPY)
+		throw runtime_error("The SPY method (-p spy) cannot be used in a server");
+	if (opts.numbering != BFS_ORDER)
+		throw runtime_error("States cannot be renumbered (-n) in a server");
+	if (opts.first_random_test != 0)
+		throw runtime_error("A server cannot start at a given random test (-i)");
+
+	session_options ret;
+	ret.fixed_part = opts.mode != RANDOM;
+	ret.random_part = opts.mode != FIXED;
+	ret.no_suffix = opts.suffix_mode == NOSUFFIX;
+	ret.use_distinguishing_sequence = opts.suffix_mode == HADS;
+	ret.prefixes = prefix_options(opts.prefix_mode);
+	ret.k_max = opts.k_max;
+	ret.l = opts.l;
+	ret.rnd_length = opts.rnd_length;
+	ret.seed = opts.seed;
+	ret.skip_dup = opts.skip_dup;
+	ret.philox = opts.generator_mode == PHILOX;
+	ret.minimize = opts.minimize;
+	ret.shortest_separators = opts.separators == SHORTEST_SEPARATORS;
+	return ret;
+}
+
+// Parses the options of an options request, as if given on the command line
+static session_options parse_session_options(string const & line) {
+	vector<string> words{"main"};
+	stringstream ss(line);
+	string w;
+	while (ss >> w) words.push_back(w);
+
+	vector<char *> argv;
+	for (auto & x : words) argv.push_back(&x[0]);
+	argv.push_back(nullptr);
+	return to_session_options(read_options(int(words.size()), argv.data()));
+}
+
+// Everything which determines the generated suite, stored in checkpoints
+static string describe_options(main_options const & opts) {
+	stringstream ss;
+	ss << opts.mode << ' ' << opts.prefix_mode << ' ' << opts.suffix_mode << ' ' << opts.k_max << ' '
+	   << opts.l << ' ' << opts.rnd_length << ' ' << opts.skip_dup << ' ' << opts.generator_mode
+	   << ' ' << opts.random_mode << ' ' << opts.format << ' ' << opts.part.index << '/'
+	   << opts.part.count << ' ' << opts.minimize << ' ' << opts.separators << ' ' << opts.tries
+	   << ' ' << opts.numbering << ' ' << opts.alphabet << ' ' << opts.input_filename;
+	return ss.str();
+}
+
+// Checkpoints are written at most this often
+static const auto checkpoint_interval = chrono::seconds(60);
+
 using time_logger = silent_timer;
 
 int main(int argc, char * argv[]) try {
@@ -164,16 +392,44 @@ int main(int argc, char * argv[]) try {
 		exit(0);
 	}
 
+	if (args.mode == SERVER) {
+		// The hypotheses are given by requests, and the structures are kept between them
+		session s(to_session_options(args));
+		if (args.socket_path.empty()) {
+			serve(cin, cout, s, parse_session_options);
+		} else {
+			serve_unix_socket(args.socket_path, s, parse_session_options);
+		}
+		return 0;
+	}
+
 	const bool no_suffix = args.suffix_mode == NOSUFFIX;
 	const bool use_distinguishing_sequence = args.suffix_mode == HADS;
 
 	const bool randomize_hopcroft = true;
 	const bool randomize_lee_yannakakis = true;
+	const bool search_family = !no_suffix && args.tries > 1;
 
 	if (args.output_filename != "" && args.output_filename != "-") {
 		throw runtime_error("File ouput is currently not supported");
 	}
 
+	// When resuming, the checkpoint determines the seeds and which tests are already done. We will
+	// remove redundancies using a radix tree/prefix tree/trie, which is also stored in a checkpoint.
+	trie<input> test_suite;
+	checkpoint progress;
+	if (args.resume) {
+		progress = read_checkpoint(args.checkpoint_filename, test_suite);
+		if (progress.options != describe_options(args))
+			throw runtime_error("The checkpoint was made with different options");
+	}
+	progress.options = describe_options(args);
+
+#ifndef _WIN32
+	// We want to write a last checkpoint when the output is closed, instead of being killed
+	if (!args.checkpoint_filename.empty()) signal(SIGPIPE, SIG_IGN);
+#endif
+
 	/*
 	 * Then all the setup is done. Parsing the automaton,
 	 * construction all types of sequences needed for the
@@ -183,25 +439,55 @@ int main(int argc, char * argv[]) try {
 		const auto & filename = args.input_filename;
 		time_logger t_("reading file " + filename);
 		if (filename == "" || filename == "-") {
-			return read_mealy_from_dot(cin);
+			return read_mealy_from_dot(cin, false);
 		}
 		if (filename.find(".txt") != string::npos) {
-			const auto m = read_mealy_from_txt(filename);
+			const auto m = read_mealy_from_txt(filename, false);
 			const auto t = create_translation_for_mealy(m);
 			return make_pair(move(m), move(t));
 		} else if (filename.find(".dot") != string::npos) {
-			return read_mealy_from_dot(filename);
+			return read_mealy_from_dot(filename, false);
 		}
 
 		clog << "warning: unrecognized file format, assuming .dot\n";
-		return read_mealy_from_dot(filename);
+		return read_mealy_from_dot(filename, false);
 	}();
 
-	const auto & machine = reachable_submachine(move(machine_and_translation.first), 0);
+	// With merged inputs, the machine has a class of inputs where it would have an input
+	vector<vector<input>> input_members;
+	const auto machine = [&] {
+		// reachable_submachine numbers the states in bfs order
+		auto m = reachable_submachine(move(machine_and_translation.first), 0);
+		if (args.alphabet != KEEP_INPUTS) {
+			time_logger t("merging identical inputs");
+			auto classes = merge_identical_inputs(m);
+			m = move(classes.machine);
+			input_members = move(classes.members);
+		}
+		if (args.minimize) {
+			time_logger t("minimizing");
+			m = minimize(m).machine;
+		}
+		if (args.numbering == CUTHILL_MCKEE) {
+			time_logger t("renumbering states");
+			m = renumber(m, cuthill_mckee_order(m, 0));
+		}
+		return m;
+	}();
 	const auto & translation = machine_and_translation.second;
 
-	// every thread gets its own seed
+	// The file may have changed since the checkpoint, so we compare the machines themselves
+	const auto machine_fingerprint
+	    = fingerprint(machine, create_reverse_map(translation.input_indices));
+	if (args.resume && progress.machine != machine_fingerprint)
+		throw runtime_error("The checkpoint was made for a different specification");
+	progress.machine = machine_fingerprint;
+
+	// every thread gets its own seed (and every shard its own random part). With philox, all shards
+	// share the seed of the random part, and they divide the test indices among each other.
 	const auto random_seeds = [&] {
+		if (args.resume) return progress.seeds;
+
 		vector<uint_fast32_t> seeds(4);
 		if (args.seed != 0) {
 			seed_seq s{args.seed};
@@ -210,11 +496,21 @@ int main(int argc, char * argv[]) try {
 			random_device rd;
 			generate(seeds.begin(), seeds.end(), ref(rd));
 		}
+		if (args.part.count > 1 && args.generator_mode == MERSENNE) {
+			seed_seq s{seeds[3], uint_fast32_t(args.part.index)};
+			s.generate(seeds.begin() + 3, seeds.end());
+		}
 		return seeds;
 	}();
+	progress.seeds = random_seeds;
 
 	auto all_pair_separating_sequences = [&] {
-		if (no_suffix) return splitting_tree(0, 0);
+		if (no_suffix || search_family) return splitting_tree(0, 0);
+
+		if (args.separators == SHORTEST_SEPARATORS) {
+			time_logger t("creating tree of shortest separators");
+			return create_shortest_splitting_tree(machine).root;
+		}
 
 		const auto splitting_tree_hopcroft = [&] {
 			time_logger t("creating hopcroft splitting tree");
@@ -227,7 +523,7 @@ int main(int argc, char * argv[]) try {
 	}();
 
 	auto sequence = [&] {
-		if (no_suffix) return adaptive_distinguishing_sequence(0, 0);
+		if (no_suffix || search_family) return adaptive_distinguishing_sequence(0, 0);
 
 		const auto tree = [&] {
 			time_logger t("Lee & Yannakakis I");
@@ -250,33 +546,54 @@ int main(int argc, char * argv[]) try {
 	}();
 
 	auto transfer_sequences = [&] {
-		if (args.mode == WSET) return vector<word>{};
+		if (args.mode == WSET) return ::transfer_sequences{};
 
 		time_logger t("determining transfer sequences");
-		switch (args.prefix_mode) {
-		case LEXMIN:
-			return create_transfer_sequences(canonical_transfer_sequences, machine, 0,
-			                                 random_seeds[2]);
-		case MIN:
-			return create_transfer_sequences(minimal_transfer_sequences, machine, 0,
-			                                 random_seeds[2]);
-		case BUGGY:
-			return create_transfer_sequences(buggy_transfer_sequences, machine, 0, random_seeds[2]);
-		case DFS:
-			return create_transfer_sequences(longest_transfer_sequences, machine, 0,
-			                                 random_seeds[2]);
-		}
+		return create_transfer_sequences(prefix_options(args.prefix_mode), machine, 0,
+		                                 random_seeds[2]);
 	}();
 
-	auto const inputs = create_reverse_map(translation.input_indices);
+	// The names of the inputs of machine, a class is named after its first input
+	auto const original_inputs = create_reverse_map(translation.input_indices);
+	auto const inputs = [&] {
+		if (input_members.empty()) return original_inputs;
+		vector<string> names;
+		for (auto const & c : input_members) names.push_back(original_inputs[c[0]]);
+		return names;
+	}();
+
+	// With -a sample, every input in the output is a random input of its class
+	const bool sample_inputs = args.alphabet == SAMPLE_INPUTS;
+	mt19937 sample_generator(random_seeds[3] + 1);
+	const auto sample = [&](input x) {
+		auto const & c = input_members[x];
+		return c[uniform_int_distribution<size_t>(0, c.size() - 1)(sample_generator)];
+	};
+	word sampled;
+	const auto sample_word = [&](const auto & w) -> word const & {
+		sampled.clear();
+		for (auto x : w) sampled.push_back(sample(x));
+		return sampled;
+	};
 
 	const auto separating_family = [&] {
 		if (no_suffix) {
-			separating_set s{{word{}}};
-			vector<separating_set> suffixes(machine.graph_size, s);
+			::separating_family suffixes;
+			separating_set s{{suffixes.suffixes.intern(word{})}};
+			suffixes.sets.assign(machine.graph_size, s);
 			return suffixes;
 		}
 
+		if (search_family) {
+			time_logger t("searching for a small seperating family");
+			family_search_options opts;
+			opts.tries = args.tries;
+			opts.use_distinguishing_sequence = use_distinguishing_sequence;
+			opts.shortest_separators = args.separators == SHORTEST_SEPARATORS;
+			return search_separating_family(machine, transfer_sequences, args.k_max + 1, opts,
+			                                random_seeds[0], random_seeds[1]);
+		}
+
 		time_logger t("making seperating family");
 		return create_separating_family(sequence, all_pair_separating_sequences);
 	}();
@@ -289,20 +606,103 @@ int main(int argc, char * argv[]) try {
 	const bool fixed_part = args.mode == ALL || args.mode == FIXED;
 	const bool random_part = args.mode == ALL || args.mode == RANDOM;
 
-	// we will remove redundancies using a radix tree/prefix tree/trie
-	trie<input> test_suite;
+	if (args.mode == PLAN) {
+		// We only count the fixed part, as the random part is infinite. The first part is made
+		// prefix-free completely, the second part only w.r.t. earlier tests. So the actual size of
+		// the second part lies roughly between the two numbers (with -e it is the first one).
+		time_logger t("planning");
+		const auto sizes = count_tests(machine, transfer_sequences, separating_family, args.k_max + 1);
+
+		size_t suffixes = 0;
+		for (const auto & wp : separating_family.sets) suffixes += wp.local_suffixes.size();
+		cout << "states " << machine.graph_size << ", inputs " << machine.input_size
+		     << ", suffixes " << suffixes << " (" << separating_family.suffixes.size()
+		     << " distinct)\n\n";
+
+		const auto print = [](string const & part, string const & k, suite_size const & size) {
+			cout << part << '\t' << k << '\t' << size_t(size.tests) << '\t' << size_t(size.symbols)
+			     << '\n';
+		};
+		cout << "part\tk\ttests\tsymbols\n";
+		const auto print_part = [&](string const & part, size_t k_min, size_t k_max) {
+			suite_size total;
+			for (size_t k = k_min; k < k_max; ++k) {
+				print(part, to_string(k), sizes[k]);
+				total.tests += sizes[k].tests;
+				total.symbols += sizes[k].symbols;
+			}
+			print(part, "all", total);
+			print(part, "prefix-free (estimated)",
+			      estimate_prefix_free_size(machine, transfer_sequences, separating_family, k_min,
+			                                k_max, 10000, random_seeds[3]));
+		};
+		print_part("first", 0, args.l + 1);
+		print_part("second", args.l + 1, args.k_max + 1);
+		return 0;
+	}
+
+	if (args.mode == CHECKING) {
+		// The fixed part, as a few long sequences without resets. We look for a synchronizing
+		// sequence, so that the first sequence does not need a reset.
+		time_logger t("outputting checking sequences");
+		const auto start = create_synchronizing_sequence(machine, 1 << 22);
+		const writer sampling_writer{
+		    [&](word_view w) {
+			    for (auto x : sample_word(w)) cout << original_inputs[x] << ' ';
+			},
+		    [] {
+			    cout << endl;
+			    return bool(cout);
+			}};
+		checking_sequences(machine, separating_family, args.k_max + 1, start,
+		                   sample_inputs ? sampling_writer : default_writer(inputs, cout));
+		return 0;
+	}
+
 	word buffer;
-	const auto output_word = [&inputs](const auto & w) {
-		for (const auto & x : w) {
-			cout << inputs[x] << ' ';
+	// Front coding only pays off when consecutive tests are similar, so then we do not shuffle
+	const bool front_coded = args.format == FRONT || args.format == FRONT_IDS;
+	front_coder coder(sample_inputs ? original_inputs : inputs, args.format == FRONT_IDS);
+	if (front_coded) coder.write_header(cout);
+
+	const auto format_word = [&](const auto & w, ostream & out) {
+		if (sample_inputs && front_coded) {
+			coder.write(sample_word(w), out);
+		} else if (sample_inputs) {
+			for (const auto & x : sample_word(w)) {
+				out << original_inputs[x] << ' ';
+			}
+		} else if (front_coded) {
+			coder.write(w, out);
+		} else {
+			for (const auto & x : w) {
+				out << inputs[x] << ' ';
+			}
 		}
-		cout << endl;
+		out << '\n';
+	};
+
+	// With checkpoints we keep the tests which may not have been read, for this we need their sizes
+	const bool checkpointing = !args.checkpoint_filename.empty();
+	unconfirmed_tests unconfirmed(1); // standard output
+	stringstream line;
+	const auto output_word = [&](const auto & w) {
+		if (!checkpointing) {
+			format_word(w, cout);
+			cout << flush;
+			return;
+		}
+		line.str("");
+		format_word(w, line);
+		const auto formatted = line.str();
+		cout << formatted << flush;
+		unconfirmed.written(word(begin(w), end(w)), formatted.size(), bool(cout));
 	};
 
 	if (args.mode == WSET) {
-		for(const auto & wp : separating_family) {
+		for(const auto & wp : separating_family.sets) {
 			for(const auto & w : wp.local_suffixes){
-				test_suite.insert(w);
+				test_suite.insert(separating_family.suffixes[w]);
 			}
 		}
 		test_suite.for_each(output_word);
@@ -310,58 +710,195 @@ int main(int argc, char * argv[]) try {
 		return 0;
 	}
 
-	if (fixed_part) {
+	if (args.format == TREE) {
+		// The tree needs all tests, so we collect the complete fixed part first
+		time_logger t("outputting the preset tests as tree");
+		vector<word> all_sequences(1);
+		if (args.prefix_mode == SPY) {
+			spy_test(machine, transfer_sequences, separating_family, args.k_max + 1, test_suite);
+		} else {
+			test(machine, transfer_sequences, all_sequences, separating_family, args.k_max + 1,
+			     {[&buffer](auto const & w) { buffer.insert(buffer.end(), w.begin(), w.end()); },
+			      [&buffer, &test_suite]() {
+				      test_suite.insert(buffer);
+				      buffer.clear();
+				      return true;
+				  }},
+			     args.part);
+		}
+		write_tree(test_suite, inputs, cout);
+		return 0;
+	}
+
+	// Writes a checkpoint, if asked for and if the last one is old enough (or when forced)
+	auto last_checkpoint = chrono::steady_clock::now();
+	const auto save_progress = [&](bool force) {
+		if (args.checkpoint_filename.empty()) return;
+		const auto now = chrono::steady_clock::now();
+		if (!force && now - last_checkpoint < checkpoint_interval) return;
+		progress.pending = unconfirmed.words();
+		write_checkpoint(progress, test_suite, args.checkpoint_filename);
+		last_checkpoint = now;
+	};
+
+	// Writes the tests which may not have been read in the previous run, they are kept until read
+	const auto output_pending = [&] {
+		const auto pending = move(progress.pending);
+		progress.pending.clear();
+		for (auto const & w : pending) output_word(w);
+		return bool(cout);
+	};
+
+	if (!fixed_part && progress.stage < checkpoint::RANDOM_PART) {
+		progress.stage = checkpoint::RANDOM_PART;
+	}
+
+	if (!output_pending()) {
+		save_progress(true);
+		return 0;
+	}
+
+	vector<word> mid_sequences(1);
+	bool mid_sequences_done = false;
+	if (fixed_part && progress.stage == checkpoint::FIRST_PART) {
 		// For the exhaustive/preset part we first collect all words
 		// (while removing redundant ones) before outputting them.
 		time_logger t("outputting all preset tests");
 
-		vector<word> mid_sequences(1);
-		test(machine, transfer_sequences, mid_sequences, separating_family, args.l + 1,
-		     {[&buffer](auto const & w) { buffer.insert(buffer.end(), w.begin(), w.end()); },
-		      [&buffer, &test_suite]() {
-			      test_suite.insert(buffer);
-			      buffer.clear();
-			      return true;
-			  }});
+		if (!args.resume && args.prefix_mode == SPY) {
+			spy_test(machine, transfer_sequences, separating_family, args.l + 1, test_suite);
+		} else if (!args.resume) {
+			test(machine, transfer_sequences, mid_sequences, separating_family, args.l + 1,
+			     {[&buffer](auto const & w) { buffer.insert(buffer.end(), w.begin(), w.end()); },
+			      [&buffer, &test_suite]() {
+				      test_suite.insert(buffer);
+				      buffer.clear();
+				      return true;
+				  }},
+			     args.part);
+			mid_sequences_done = true;
+		}
 
 		auto first_suite = flatten(test_suite);
 		mt19937 g;
-		shuffle(first_suite.begin(), first_suite.end(), g);
-		for (auto const & w : first_suite) output_word(w);
+		if (!front_coded) shuffle(first_suite.begin(), first_suite.end(), g);
+		// A test which could not be written is kept as unconfirmed, so we count it as done
+		while (progress.position < first_suite.size()) {
+			output_word(first_suite[progress.position++]);
+			if (!cout) break;
+			save_progress(false);
+		}
 		first_suite.clear();
 
+		if (!cout) {
+			save_progress(true);
+			return 0;
+		}
+
+		progress.stage = checkpoint::SECOND_PART;
+		save_progress(true);
+	}
+
+	if (fixed_part && progress.stage == checkpoint::SECOND_PART) {
+		if (!mid_sequences_done) {
+			for (size_t k = 0; k <= args.l; ++k) {
+				mid_sequences = all_seqs(0, machine.input_size, mid_sequences);
+			}
+		}
+
 		test(machine, transfer_sequences, mid_sequences, separating_family, args.k_max - args.l,
 		     {[&buffer](auto const & w) { buffer.insert(buffer.end(), w.begin(), w.end()); },
-		      [&buffer, &test_suite, &output_word, &args]() {
+		      [&]() {
 			      if (!args.skip_dup || test_suite.insert(buffer)) {
 				      output_word(buffer);
 			      }
+			      const auto ok = bool(cout);
 			      buffer.clear();
-			      return bool(cout);
-			   }});
+			      if (ok) save_progress(false);
+			      return ok;
+			  }},
+		     args.part, progress.cursor);
+
+		if (!cout) {
+			save_progress(true);
+			return 0;
+		}
+
+		progress.stage = checkpoint::RANDOM_PART;
+		save_progress(true);
 	}
 
-	if (random_part) {
+	if (random_part && progress.stage == checkpoint::RANDOM_PART) {
 		// For the random part we immediately output new words, since
 		// there is no way of collecting an infinite set first...
 		// Note that this part terminates when the stream is closed.
 		time_logger t("outputting all random tests");
 		const auto k_max_ = fixed_part ? args.k_max + 1 : 0;
 
-		randomized_test(
-		    machine, transfer_sequences, separating_family, k_max_, args.rnd_length,
-		    {[&buffer](auto const & w) { buffer.insert(buffer.end(), w.begin(), w.end()); },
-		     [&buffer, &test_suite, &output_word, &args]() {
-			     // TODO: probably we want to bound the size of the prefix tree
-			     if (!args.skip_dup || test_suite.insert(buffer)) {
-				     output_word(buffer);
-			     }
-			     buffer.clear();
-			     return bool(cout);
-			 }},
-		    random_seeds[3]);
+		// With philox the progress is simply the index of the next test, with coverage guidance it
+		// includes the counters
+		mt19937 generator(random_seeds[3]);
+		coverage counters(machine, separating_family);
+		size_t next_test = args.first_random_test + (args.part.index + args.part.count
+		                                             - args.first_random_test % args.part.count)
+		                                                % args.part.count;
+		if (!progress.generator.empty()) {
+			stringstream ss(progress.generator);
+			if (args.generator_mode == PHILOX) {
+				ss >> next_test;
+			} else {
+				ss >> generator;
+				if (args.random_mode == COVERAGE) counters.read(ss);
+			}
+		}
+		const auto save_random_progress = [&](bool force) {
+			if (args.checkpoint_filename.empty()) return;
+			stringstream ss;
+			if (args.generator_mode == PHILOX) {
+				ss << next_test;
+			} else {
+				ss << generator;
+				if (args.random_mode == COVERAGE) {
+					ss << ' ';
+					counters.write(ss);
+				}
+			}
+			progress.generator = ss.str();
+			save_progress(force);
+		};
+
+		const writer random_writer = {
+		    [&buffer](auto const & w) { buffer.insert(buffer.end(), w.begin(), w.end()); },
+		    [&]() {
+			    // TODO: probably we want to bound the size of the prefix tree
+			    if (!args.skip_dup || test_suite.insert(buffer)) {
+				    output_word(buffer);
+			    }
+			    const auto ok = bool(cout);
+			    buffer.clear();
+			    if (ok && chrono::steady_clock::now() - last_checkpoint >= checkpoint_interval) {
+				    save_random_progress(false);
+			    }
+			    return ok;
+			}};
+
+		if (args.generator_mode == PHILOX) {
+			randomized_test(machine, transfer_sequences, separating_family, k_max_, args.rnd_length,
+			                random_writer, random_seeds[3], next_test, args.part.count);
+		} else if (args.random_mode == COVERAGE) {
+			randomized_test_coverage(machine, transfer_sequences, separating_family, k_max_,
+			                         args.rnd_length, random_writer, generator, counters);
+		} else {
+			randomized_test(machine, transfer_sequences, separating_family, k_max_, args.rnd_length,
+			                random_writer, generator);
+		}
+
+		save_random_progress(true);
+		return 0;
 	}
 
+	progress.stage = checkpoint::DONE;
+	save_progress(true);
 } catch (exception const & e) {
 	cerr << "Exception thrown: " << e.what() << endl;
 	return 1;
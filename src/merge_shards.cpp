@@ -0,0 +1,115 @@
+#include <trie.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+extern "C" {
+#include <windows_getopt.h>
+}
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char USAGE[] =
+    R"(Merge the outputs of a sharded test suite (generated with main -S i/n).
+
+    Usage:
+      merge_shards [options] <shard files>...
+
+    Options:
+      -h             Show this screen
+      -c <filename>  Verify that the merged suite equals this (unsharded) suite
+      -q             Do not output the merged suite
+
+    Tests are compared after removing tests which are a prefix of other tests.
+    So the random part of a suite cannot be verified.
+)";
+
+using symbol_map = unordered_map<string, size_t>;
+
+// Reads a suite (one test per line, symbols separated by spaces) into t
+static void read_suite(string const & filename, symbol_map & symbols, trie<size_t> & t) {
+	ifstream file(filename);
+	if (!file) throw runtime_error("Could not open " + filename);
+
+	string line;
+	vector<size_t> w;
+	while (getline(file, line)) {
+		w.clear();
+		stringstream ss(line);
+		string symbol;
+		while (ss >> symbol) {
+			const auto it = symbols.emplace(symbol, symbols.size()).first;
+			w.push_back(it->second);
+		}
+		t.insert(w);
+	}
+}
+
+int main(int argc, char * argv[]) try {
+	string reference;
+	bool quiet = false;
+
+	int c;
+	while ((c = getopt(argc, argv, "hc:q")) != -1) {
+		switch (c) {
+		case 'h':
+			cout << USAGE << endl;
+			return 0;
+		case 'c':
+			reference = optarg;
+			break;
+		case 'q':
+			quiet = true;
+			break;
+		default:
+			cerr << "Please use -h to see the available options." << endl;
+			return 2;
+		}
+	}
+
+	symbol_map symbols;
+	trie<size_t> merged;
+	for (int i = optind; i < argc; ++i) {
+		read_suite(argv[i], symbols, merged);
+	}
+
+	if (!quiet) {
+		vector<string> names(symbols.size());
+		for (auto && p : symbols) names[p.second] = p.first;
+
+		merged.for_each([&names](vector<size_t> const & w) {
+			for (auto && x : w) cout << names[x] << ' ';
+			cout << '\n';
+		});
+		cout << flush;
+	}
+
+	if (reference.empty()) return 0;
+
+	trie<size_t> expected;
+	read_suite(reference, symbols, expected);
+
+	const auto merged_words = flatten(merged);
+	const auto expected_words = flatten(expected);
+	if (merged_words != expected_words) {
+		cerr << "The shards do not match the reference: " << merged_words.size() << " tests versus "
+		     << expected_words.size() << " tests" << endl;
+		return 1;
+	}
+
+	cerr << "The shards match the reference (" << merged_words.size() << " tests)" << endl;
+	return 0;
+} catch (exception const & e) {
+	cerr << "Exception thrown: " << e.what() << endl;
+	return 1;
+}
@@ -0,0 +1,97 @@
+#include <adaptive_distinguishing_sequence.hpp>
+#include <mealy.hpp>
+#include <reachability.hpp>
+#include <read_mealy.hpp>
+#include <renumbering.hpp>
+#include <separating_family.hpp>
+#include <splitting_tree.hpp>
+#include <test_suite.hpp>
+#include <transfer_sequences.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Compares the numberings of states: as in the file, breadth first (what reachable_submachine
+ * gives), and Cuthill-McKee. For each we show how far transitions jump (the rows of the graph are
+ * allocated in order, so a short jump is a nearby memory access), and how long the phases take.
+ * Run it under a profiler (e.g. perf stat -e cache-misses) to see the cache misses themselves.
+ *
+ * Usage: renumbering_benchmark <machine.dot> [k]
+ */
+
+static double seconds_since(chrono::steady_clock::time_point start) {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static void measure(string const & name, mealy const & machine, size_t k_max) {
+	// Locality: the mean distance of a transition, and how many stay within 64 states. Undefined
+	// transitions (in a partial machine) go nowhere, so they are not counted.
+	double distance = 0;
+	size_t near = 0;
+	size_t defined = 0;
+	for (state s = 0; s < machine.graph_size; ++s) {
+		for (auto && e : machine.graph[s]) {
+			if (e.to == state(-1)) continue;
+			const auto d = e.to > s ? e.to - s : s - e.to;
+			distance += d;
+			if (d < 64) near++;
+			defined++;
+		}
+	}
+	const auto edges = double(max<size_t>(defined, 1));
+
+	auto start = chrono::steady_clock::now();
+	const auto hopcroft = create_splitting_tree(machine, randomized_hopcroft_style, 1);
+	const auto t_hopcroft = seconds_since(start);
+
+	start = chrono::steady_clock::now();
+	const auto lee_yannakakis = create_splitting_tree(machine, randomized_lee_yannakakis_style, 1);
+	const auto sequence = create_adaptive_distinguishing_sequence(lee_yannakakis);
+	const auto family = create_separating_family(sequence, hopcroft.root);
+	const auto t_family = seconds_since(start);
+
+	start = chrono::steady_clock::now();
+	const auto prefixes = create_transfer_sequences(minimal_transfer_sequences, machine, 0, 1);
+	size_t symbols = 0;
+	test(machine, prefixes, family, k_max,
+	     {[&symbols](word_view w) { symbols += w.size(); }, [] { return true; }});
+	const auto t_tests = seconds_since(start);
+
+	cout << setw(6) << name << setw(12) << fixed << setprecision(1) << distance / edges
+	     << setw(10) << setprecision(3) << near / edges << setw(11) << t_hopcroft << setw(11)
+	     << t_family << setw(11) << t_tests << "  (" << symbols << " symbols)" << endl;
+}
+
+int main(int argc, char * argv[]) {
+	if (argc < 2) {
+		cerr << "usage: renumbering_benchmark <machine.dot> [k]" << endl;
+		return 1;
+	}
+	const size_t k_max = argc > 2 ? stoul(argv[2]) : 1;
+
+	const auto machine = read_mealy_from_dot(argv[1], false).first;
+	vector<state> old_to_new;
+	const auto bfs = reachable_submachine(machine, 0, old_to_new);
+
+	// The reachable states in the order of the file. This renumbers bfs (and not the machine as
+	// read), as only reachable_submachine makes every row complete in a partial machine.
+	vector<state> file_order;
+	for (state s = 0; s < machine.graph_size; ++s) {
+		if (old_to_new[s] != state(-1)) file_order.push_back(old_to_new[s]);
+	}
+
+	cout << machine.graph_size << " states, " << machine.input_size << " inputs, k = " << k_max
+	     << endl;
+	cout << " order    distance  near(64)   hopcroft  sep.fam.      tests" << endl;
+	measure("file", renumber(bfs, file_order), k_max);
+	measure("bfs", bfs, k_max);
+	measure("cm", renumber(bfs, cuthill_mckee_order(bfs, 0)), k_max);
+}
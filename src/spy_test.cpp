@@ -0,0 +1,128 @@
+#include <adaptive_distinguishing_sequence.hpp>
+#include <mealy.hpp>
+#include <separating_family.hpp>
+#include <splitting_tree.hpp>
+#include <test_suite.hpp>
+#include <transfer_sequences.hpp>
+#include <trie.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+static void check(bool r) {
+	if (!r) throw runtime_error("error in spy_test");
+}
+
+// Four states, inputs a = 0 and b = 1. With canonical transfer sequences the access sequences are
+// 0: e, 1: a, 2: b, 3: ab. The transitions 2 -b-> 0 and 3 -b-> 1 go back to earlier states.
+static mealy create_machine() {
+	mealy m;
+	m.graph_size = 4;
+	m.input_size = 2;
+	m.output_size = 2;
+	m.graph = {
+	    {{1, 0}, {2, 0}}, // 0
+	    {{2, 0}, {3, 1}}, // 1
+	    {{3, 0}, {0, 1}}, // 2
+	    {{3, 1}, {1, 0}}, // 3
+	};
+	return m;
+}
+
+static word concat(word const & p, word const & m, word_view e) {
+	word w = p;
+	w.insert(w.end(), m.begin(), m.end());
+	w.insert(w.end(), e.begin(), e.end());
+	return w;
+}
+
+static void test_alternatives() {
+	const auto machine = create_machine();
+	const auto prefixes = create_transfer_sequences(canonical_transfer_sequences, machine, 0, 0);
+	check(prefixes[0] == word{});
+	check(prefixes[1] == word{0});
+	check(prefixes[2] == word{1});
+	check(prefixes[3] == (word{0, 1}));
+
+	const auto alternatives = spy_alternatives(machine, prefixes);
+	check(alternatives[0].empty());
+	check(alternatives[1].empty());
+	check(alternatives[2] == vector<word>{{0, 0}});
+	check(alternatives[3] == (vector<word>{{1, 0}, {0, 0, 0}}));
+
+	// In general: an alternative reaches its state, and its last transition comes from an earlier
+	// state (a shorter access sequence, or an equal one and a lower number)
+	vector<state> order(machine.graph_size);
+	iota(order.begin(), order.end(), 0);
+	stable_sort(order.begin(), order.end(),
+	            [&](state s, state t) { return prefixes.length[s] < prefixes.length[t]; });
+	vector<size_t> rank(machine.graph_size);
+	for (size_t i = 0; i < order.size(); ++i) rank[order[i]] = i;
+
+	for (state s = 0; s < machine.graph_size; ++s) {
+		for (auto const & a : alternatives[s]) {
+			check(!a.empty() && a != prefixes[s]);
+			check(apply(machine, 0, a.begin(), a.end()).to == s);
+			const auto r = apply(machine, 0, a.begin(), a.end() - 1).to;
+			check(rank[r] < rank[s]);
+		}
+	}
+}
+
+static void test_suite() {
+	const auto machine = create_machine();
+	const auto prefixes = create_transfer_sequences(canonical_transfer_sequences, machine, 0, 0);
+	const auto hopcroft = create_splitting_tree(machine, hopcroft_style, 1);
+	const auto lee_yannakakis = create_splitting_tree(machine, lee_yannakakis_style, 1);
+	const auto sequence = create_adaptive_distinguishing_sequence(lee_yannakakis);
+	const auto family = create_separating_family(sequence, hopcroft.root);
+	const auto alternatives = spy_alternatives(machine, prefixes);
+
+	// The tests with an empty middle keep the access sequence. Here the suite already contains
+	// these tests via the alternatives, so the alternatives would be free.
+	trie<input> suite;
+	for (state s = 0; s < machine.graph_size; ++s) {
+		for (auto const & a : alternatives[s]) {
+			for (auto id : family[s].local_suffixes) suite.insert(concat(a, {}, family.suffixes[id]));
+		}
+	}
+	spy_test(machine, prefixes, family, 1, suite);
+	for (state s = 0; s < machine.graph_size; ++s) {
+		for (auto id : family[s].local_suffixes) {
+			check(suite.growth(concat(prefixes[s], {}, family.suffixes[id])) == 0);
+		}
+	}
+
+	// The tests with a middle of one symbol may start with an alternative
+	suite.clear();
+	spy_test(machine, prefixes, family, 2, suite);
+	for (state s = 0; s < machine.graph_size; ++s) {
+		for (input y = 0; y < machine.input_size; ++y) {
+			const auto t = apply(machine, s, y).to;
+			for (auto id : family[t].local_suffixes) {
+				const auto suffix = family.suffixes[id];
+				bool found = suite.growth(concat(prefixes[s], {y}, suffix)) == 0;
+				for (auto const & a : alternatives[s]) {
+					found = found || suite.growth(concat(a, {y}, suffix)) == 0;
+				}
+				check(found);
+			}
+		}
+	}
+
+	suite.for_each([](auto && w) {
+		for (auto && i : w) cout << i;
+		cout << '\n';
+	});
+	cout << endl;
+}
+
+int main() {
+	test_alternatives();
+	test_suite();
+}
@@ -6,7 +6,9 @@
 #include <numeric>
 #include <random>
 #include <set>
+#include <sstream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 using namespace std;
@@ -43,6 +45,91 @@ static void test() {
 	cout << endl;
 }
 
+static void test_write_read() {
+	trie<unsigned> t;
+	t.insert(word{1, 2, 3});
+	t.insert(word{2, 3});
+	t.insert(word{5, 5, 3, 1});
+	t.insert(word{5, 5, 5});
+
+	stringstream ss;
+	t.write(ss);
+	trie<unsigned> t2;
+	t2.read(ss);
+	check(flatten(t2) == flatten(t));
+
+	// The empty trie is read back as empty, also when the target was not
+	trie<unsigned> empty;
+	stringstream ss2;
+	empty.write(ss2);
+	t2.read(ss2);
+	check(flatten(t2).empty());
+
+	// Only the empty word is different from the empty trie
+	trie<unsigned> epsilon;
+	epsilon.insert(word{});
+	stringstream ss3;
+	epsilon.write(ss3);
+	t2.read(ss3);
+	check(flatten(t2) == vector<vector<unsigned>>(1));
+}
+
+static void test_for_each_branch() {
+	trie<unsigned> t;
+	t.insert(word{1, 2, 3});
+	t.insert(word{2, 3});
+	t.insert(word{5, 5, 3, 1});
+	t.insert(word{5, 5, 5});
+
+	// Children are visited in order of their symbol, and the last child needs no snapshot
+	string log;
+	t.for_each_branch(
+	    [&log](auto&& w) {
+		    log += '(';
+		    for (auto&& i : w) log += to_string(i);
+		    log += ')';
+		},
+	    [&log] { log += '<'; }, [&log] { log += '>'; });
+	check(log == "<(123)><(23)>(55)<(31)>(5)");
+
+	// Nothing happens for the empty trie
+	trie<unsigned> empty;
+	log.clear();
+	empty.for_each_branch([&log](auto&&) { log += 'r'; }, [&log] { log += '<'; },
+	                      [&log] { log += '>'; });
+	check(log.empty());
+}
+
+static void test_growth() {
+	trie<unsigned> t;
+	check(t.growth(word{1, 2}) == 2);
+
+	t.insert(word{1, 2, 3});
+	t.insert(word{5, 5, 3});
+	t.insert(word{5, 5, 5});
+
+	// A prefix of a word (or the word itself) adds nothing
+	check(t.growth(word{}) == 0);
+	check(t.growth(word{1, 2}) == 0);
+	check(t.growth(word{1, 2, 3}) == 0);
+
+	// Extending a word only adds the new symbols
+	check(t.growth(word{1, 2, 3, 4, 5}) == 2);
+	check(t.growth(word{5, 5, 3, 1}) == 1);
+
+	// Branching off an inner node adds a new word, of the whole length
+	check(t.growth(word{1, 4}) == 2);
+	check(t.growth(word{5, 5, 4}) == 3);
+	check(t.growth(word{2}) == 1);
+
+	// The growth is what insert does to the total size
+	const auto before = total_size(t).second;
+	const word w = {5, 5, 3, 1, 1};
+	const auto g = t.growth(w);
+	t.insert(w);
+	check(total_size(t).second == before + g);
+}
+
 static void performance() {
 	vector<word> corpus(1000000);
 
@@ -102,5 +189,8 @@ static void performance() {
 
 int main() {
 	test();
+	test_write_read();
+	test_for_each_branch();
+	test_growth();
 	performance();
 }